@@ -0,0 +1,484 @@
+/*
+ * BabbleSim scale-test central
+ *
+ * Scans until every peripheral with the FW-CHALLENGE custom service has been
+ * seen, then connects to them one at a time. On each one it sets the sample
+ * interval over the config characteristic, writes its own clock to the
+ * time-sync characteristic and subscribes to the timestamped samples. Once all peripherals are set up it
+ * counts notifications for the measurement window. Sample timestamps are in
+ * the central's clock, so gaps give lost samples and arrival time minus
+ * timestamp gives the delivery latency.
+ *
+ * Results are printed as one SCALE-RUN and one SCALE-NODE line per peripheral
+ * (JSON); bsim/scale_report.py turns them into comparable reports.
+ *
+ * Test arguments (after -argstest):
+ *   nodes=<n> interval_ms=<ms> duration_s=<s> conn_interval=<1.25 ms units>
+ *   discover_timeout_s=<s>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/logging/log.h>
+
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "bstests.h"
+
+#include "app_uuids.h"
+
+LOG_MODULE_REGISTER(SCALE, LOG_LEVEL_INF);
+
+#define MAX_NODES CONFIG_BT_MAX_CONN
+/*
+ * Worst-case set-up of one node is CONFIG_BT_CREATE_CONN_TIMEOUT plus SETUP_STEPS
+ * times STEP_TIMEOUT; run_scale.sh sizes the simulation from both, keep them in sync.
+ */
+#define STEP_TIMEOUT K_SECONDS(5)
+#define SETUP_STEPS 6 /* three discoveries, two writes, one subscription */
+
+/* Wire format of the peripheral's config characteristic (struct app_cfg) */
+struct scale_cfg {
+    uint32_t sample_interval_ms;
+    uint16_t threshold_mv;
+    uint8_t en_ble;
+    uint8_t notify_every;
+} __packed;
+
+/* Timestamped-sample notification */
+struct scale_sample {
+    int64_t t_ms;
+    uint16_t mv;
+    uint8_t channel;
+} __packed;
+
+struct node {
+    bt_addr_le_t addr;
+    struct bt_conn *conn;
+    int64_t discovered_ms;      /* first advertising report, from scan start */
+    uint32_t adv_reports;
+    int32_t setup_ms;           /* connection create -> connected, -1 if it failed */
+    int64_t ready_ms;           /* subscribed, from scan start; -1 if set-up failed */
+    uint32_t disconnects;
+    /* Measurement window only */
+    uint32_t rx;
+    int64_t lat_sum_ms;
+    int32_t lat_max_ms;
+    struct bt_gatt_subscribe_params sub;
+    struct bt_gatt_discover_params ccc_disc;
+};
+
+static struct {
+    uint32_t nodes;
+    uint32_t interval_ms;
+    uint32_t duration_s;
+    uint32_t conn_interval;
+    uint32_t discover_timeout_s;
+} args = {
+    .nodes = 1,
+    .interval_ms = 1000,
+    .duration_s = 60,
+    .conn_interval = 40,        /* 50 ms */
+    .discover_timeout_s = 30,
+};
+
+static struct node nodes[MAX_NODES];
+static uint32_t node_count;
+static int64_t scan_start_ms;
+static atomic_t measuring;
+
+static K_SEM_DEFINE(discovered_sem, 0, 1);
+static K_SEM_DEFINE(step_sem, 0, 1);
+static uint8_t step_err;
+static uint16_t found_handle;
+
+static struct node *node_by_addr(const bt_addr_le_t *addr)
+{
+    for (uint32_t i = 0; i < node_count; i++) {
+        if (bt_addr_le_eq(&nodes[i].addr, addr)) {
+            return &nodes[i];
+        }
+    }
+    return NULL;
+}
+
+static struct node *node_by_conn(struct bt_conn *conn)
+{
+    for (uint32_t i = 0; i < node_count; i++) {
+        if (nodes[i].conn == conn) {
+            return &nodes[i];
+        }
+    }
+    return NULL;
+}
+
+/* Peripherals are recognized by the custom service UUID in their scan response, not by
+ * name: the name is a per-build Kconfig option (CONFIG_APP_BLE_DEVICE_NAME).
+ */
+static const uint8_t svc_uuid[] = { BT_UUID_CUSTOM_SERVICE_VAL };
+
+static bool ad_uuid_cb(struct bt_data *data, void *user_data)
+{
+    bool *match = user_data;
+
+    if (data->type != BT_DATA_UUID128_ALL && data->type != BT_DATA_UUID128_SOME) {
+        return true;
+    }
+    for (size_t off = 0; off + sizeof(svc_uuid) <= data->data_len; off += sizeof(svc_uuid)) {
+        if (memcmp(&data->data[off], svc_uuid, sizeof(svc_uuid)) == 0) {
+            *match = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void device_found(const bt_addr_le_t *addr, int8_t rssi, uint8_t type,
+                         struct net_buf_simple *ad)
+{
+    struct node *n = node_by_addr(addr);
+    bool match = false;
+
+    if (n) {
+        n->adv_reports++;
+        return;
+    }
+    if (node_count >= args.nodes) {
+        return;
+    }
+    bt_data_parse(ad, ad_uuid_cb, &match);
+    if (!match) {
+        return;
+    }
+
+    n = &nodes[node_count++];
+    bt_addr_le_copy(&n->addr, addr);
+    n->discovered_ms = k_uptime_get() - scan_start_ms;
+    n->adv_reports = 1;
+    n->setup_ms = -1;
+    n->ready_ms = -1;
+    if (node_count == args.nodes) {
+        k_sem_give(&discovered_sem);
+    }
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+    step_err = err;
+    k_sem_give(&step_sem);
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    struct node *n = node_by_conn(conn);
+
+    if (n) {
+        n->disconnects++;
+        LOG_WRN("node %u disconnected (0x%02x)", (unsigned int)(n - nodes), reason);
+    }
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+    .connected = connected,
+    .disconnected = disconnected,
+};
+
+static uint8_t discover_cb(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                           struct bt_gatt_discover_params *params)
+{
+    if (attr) {
+        const struct bt_gatt_chrc *chrc = attr->user_data;
+
+        found_handle = chrc->value_handle;
+    }
+    /* Stopping on the first match means the callback runs exactly once */
+    k_sem_give(&step_sem);
+    return BT_GATT_ITER_STOP;
+}
+
+/* Value handle of the characteristic with the given UUID, 0 if not found */
+static uint16_t discover_chrc(struct bt_conn *conn, const struct bt_uuid *uuid)
+{
+    static struct bt_gatt_discover_params params;
+
+    params.uuid = uuid;
+    params.func = discover_cb;
+    params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+    params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+    params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
+    found_handle = 0;
+
+    if (bt_gatt_discover(conn, &params) || k_sem_take(&step_sem, STEP_TIMEOUT)) {
+        return 0;
+    }
+    return found_handle;
+}
+
+static void write_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_write_params *params)
+{
+    step_err = err;
+    k_sem_give(&step_sem);
+}
+
+static int write_sync(struct bt_conn *conn, uint16_t handle, const void *data, uint16_t len)
+{
+    static struct bt_gatt_write_params params;
+    int err;
+
+    params.func = write_cb;
+    params.handle = handle;
+    params.offset = 0;
+    params.data = data;
+    params.length = len;
+
+    err = bt_gatt_write(conn, &params);
+    if (err) {
+        return err;
+    }
+    if (k_sem_take(&step_sem, STEP_TIMEOUT)) {
+        return -ETIMEDOUT;
+    }
+    return step_err ? -EIO : 0;
+}
+
+static uint8_t notify_cb(struct bt_conn *conn, struct bt_gatt_subscribe_params *params,
+                         const void *data, uint16_t len)
+{
+    struct node *n = CONTAINER_OF(params, struct node, sub);
+    struct scale_sample s;
+
+    if (!data) {
+        params->value_handle = 0;
+        return BT_GATT_ITER_STOP;
+    }
+    if (len != sizeof(s) || !atomic_get(&measuring)) {
+        return BT_GATT_ITER_CONTINUE;
+    }
+    memcpy(&s, data, sizeof(s));
+    s.t_ms = sys_le64_to_cpu(s.t_ms);
+    /* Unsynced (0) or secondary-channel samples */
+    if (s.t_ms == 0 || s.channel != 0) {
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    int32_t latency = (int32_t)(k_uptime_get() - s.t_ms);
+
+    n->rx++;
+    n->lat_sum_ms += latency;
+    n->lat_max_ms = MAX(n->lat_max_ms, latency);
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static void subscribe_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_subscribe_params *params)
+{
+    step_err = err;
+    k_sem_give(&step_sem);
+}
+
+static int node_connect(struct node *n)
+{
+    const struct bt_le_conn_param param =
+        BT_LE_CONN_PARAM_INIT(args.conn_interval, args.conn_interval, 0, 400);
+    int64_t start = k_uptime_get();
+    int err;
+
+    err = bt_conn_le_create(&n->addr, BT_CONN_LE_CREATE_CONN, &param, &n->conn);
+    if (err) {
+        return err;
+    }
+    /* The initiator gives up on its own after CONFIG_BT_CREATE_CONN_TIMEOUT */
+    k_sem_take(&step_sem, K_FOREVER);
+    if (step_err) {
+        bt_conn_unref(n->conn);
+        n->conn = NULL;
+        return -ENOTCONN;
+    }
+    n->setup_ms = (int32_t)(k_uptime_get() - start);
+    return 0;
+}
+
+static int node_setup(struct node *n)
+{
+    static struct scale_cfg cfg;
+    static uint8_t ref[sizeof(int64_t)];
+    uint16_t cfg_handle, sync_handle, sample_handle;
+    int err;
+
+    err = node_connect(n);
+    if (err) {
+        return err;
+    }
+
+    cfg_handle = discover_chrc(n->conn, BT_UUID_CONFIG_CHAR);
+    sync_handle = discover_chrc(n->conn, BT_UUID_TIME_SYNC_CHAR);
+    sample_handle = discover_chrc(n->conn, BT_UUID_SAMPLE_TS_CHAR);
+    if (!cfg_handle || !sync_handle || !sample_handle) {
+        return -ENOENT;
+    }
+
+    cfg.sample_interval_ms = sys_cpu_to_le32(args.interval_ms);
+    cfg.threshold_mv = sys_cpu_to_le16(3000);
+    cfg.en_ble = 1;
+    cfg.notify_every = 1;
+    err = write_sync(n->conn, cfg_handle, &cfg, sizeof(cfg));
+    if (err) {
+        return err;
+    }
+
+    /* All bsim devices share one time base, so the central's uptime is the reference */
+    sys_put_le64(k_uptime_get(), ref);
+    err = write_sync(n->conn, sync_handle, ref, sizeof(ref));
+    if (err) {
+        return err;
+    }
+
+    n->sub.notify = notify_cb;
+    n->sub.subscribe = subscribe_cb;
+    n->sub.value = BT_GATT_CCC_NOTIFY;
+    n->sub.value_handle = sample_handle;
+    n->sub.ccc_handle = 0;
+    n->sub.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+    n->sub.disc_params = &n->ccc_disc;
+    err = bt_gatt_subscribe(n->conn, &n->sub);
+    if (err) {
+        return err;
+    }
+    if (k_sem_take(&step_sem, STEP_TIMEOUT) || step_err) {
+        return -EIO;
+    }
+    n->ready_ms = k_uptime_get() - scan_start_ms;
+    return 0;
+}
+
+static void report(int64_t window_ms)
+{
+    char addr[BT_ADDR_LE_STR_LEN];
+
+    printk("SCALE-RUN {\"nodes\": %u, \"interval_ms\": %u, \"duration_s\": %u, "
+           "\"conn_interval\": %u, \"discovered\": %u, \"window_ms\": %lld}\n",
+           args.nodes, args.interval_ms, args.duration_s, args.conn_interval, node_count,
+           window_ms);
+
+    for (uint32_t i = 0; i < node_count; i++) {
+        struct node *n = &nodes[i];
+        /*
+         * Loss against what a ready node should have sent over the whole window, so a
+         * node that disconnects or stops notifying shows up, not only gaps between
+         * received samples. A window boundary can let one sample more through; clamped.
+         */
+        uint32_t expected = n->ready_ms >= 0 ? (uint32_t)(window_ms / args.interval_ms) : 0;
+        uint32_t lost = expected > n->rx ? expected - n->rx : 0;
+
+        bt_addr_le_to_str(&n->addr, addr, sizeof(addr));
+        printk("SCALE-NODE {\"node\": %u, \"addr\": \"%s\", \"discovered_ms\": %lld, "
+               "\"adv_reports\": %u, \"setup_ms\": %d, \"ready_ms\": %lld, "
+               "\"disconnects\": %u, \"rx\": %u, \"expected\": %u, \"lost\": %u, "
+               "\"lat_sum_ms\": %lld, \"lat_max_ms\": %d}\n",
+               i, addr, n->discovered_ms, n->adv_reports, n->setup_ms, n->ready_ms,
+               n->disconnects, n->rx, expected, lost, n->lat_sum_ms, n->lat_max_ms);
+    }
+}
+
+static void test_main(void)
+{
+    const struct bt_le_scan_param scan = BT_LE_SCAN_PARAM_INIT(
+        BT_LE_SCAN_TYPE_ACTIVE, BT_LE_SCAN_OPT_NONE,
+        BT_GAP_SCAN_FAST_INTERVAL, BT_GAP_SCAN_FAST_INTERVAL);
+    uint32_t ready = 0;
+    int err;
+
+    err = bt_enable(NULL);
+    if (err) {
+        bs_trace_error_line("bt_enable failed (%d)\n", err);
+    }
+
+    /* Discovery: scan only, so that the latency is not skewed by connections */
+    scan_start_ms = k_uptime_get();
+    err = bt_le_scan_start(&scan, device_found);
+    if (err) {
+        bs_trace_error_line("scan start failed (%d)\n", err);
+    }
+    if (k_sem_take(&discovered_sem, K_SECONDS(args.discover_timeout_s))) {
+        LOG_WRN("discovered %u of %u nodes", node_count, args.nodes);
+    }
+    (void)bt_le_scan_stop();
+
+    for (uint32_t i = 0; i < node_count; i++) {
+        err = node_setup(&nodes[i]);
+        if (err) {
+            LOG_WRN("node %u: set-up failed (%d)", i, err);
+            continue;
+        }
+        ready++;
+    }
+    LOG_INF("%u of %u nodes ready, measuring for %u s", ready, args.nodes, args.duration_s);
+
+    int64_t start = k_uptime_get();
+
+    atomic_set(&measuring, 1);
+    k_sleep(K_SECONDS(args.duration_s));
+    atomic_clear(&measuring);
+    report(k_uptime_get() - start);
+
+    bst_result = ready == args.nodes ? Passed : Failed;
+    bs_trace_silent_exit(0);
+}
+
+static void test_args(int argc, char *argv[])
+{
+    for (int i = 0; i < argc; i++) {
+        char *val = strchr(argv[i], '=');
+        uint32_t v;
+
+        if (!val) {
+            bs_trace_error_line("bad argument '%s'\n", argv[i]);
+        }
+        v = strtoul(val + 1, NULL, 0);
+        if (!strncmp(argv[i], "nodes=", 6)) {
+            args.nodes = CLAMP(v, 1, MAX_NODES);
+        } else if (!strncmp(argv[i], "interval_ms=", 12)) {
+            args.interval_ms = MAX(v, 10);
+        } else if (!strncmp(argv[i], "duration_s=", 11)) {
+            args.duration_s = MAX(v, 1);
+        } else if (!strncmp(argv[i], "conn_interval=", 14)) {
+            args.conn_interval = CLAMP(v, 6, 3200);
+        } else if (!strncmp(argv[i], "discover_timeout_s=", 19)) {
+            args.discover_timeout_s = MAX(v, 1);
+        } else {
+            bs_trace_error_line("unknown argument '%s'\n", argv[i]);
+        }
+    }
+}
+
+static const struct bst_test_instance test_defs[] = {
+    {
+        .test_id = "central",
+        .test_descr = "Scan, connect and measure FW-CHALLENGE peripherals",
+        .test_args_f = test_args,
+        .test_main_f = test_main,
+    },
+    BSTEST_END_MARKER
+};
+
+static struct bst_test_list *test_install(struct bst_test_list *tests)
+{
+    return bst_add_tests(tests, test_defs);
+}
+
+bst_test_install_t test_installers[] = {
+    test_install,
+    NULL
+};
+
+int main(void)
+{
+    bst_main();
+    return 0;
+}
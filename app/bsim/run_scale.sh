@@ -0,0 +1,90 @@
+#!/usr/bin/env bash
+#
+# BabbleSim scale test: N FW-CHALLENGE peripherals plus one scanning and
+# connecting central (central/), for every combination of node count and
+# sample interval. Needs a BabbleSim install (BSIM_OUT_PATH,
+# BSIM_COMPONENTS_PATH) and west.
+#
+#   run_scale.sh [-n "1 4 8 16"] [-i "1000 100 20"] [-d 60] [-c 40] [-o DIR]
+#
+#   -n  node counts              -i  sample intervals (ms)
+#   -d  measurement window (s)   -c  central connection interval (1.25 ms units)
+#   -o  result directory (default: results/<git describe>)
+#
+# Every run leaves <DIR>/n<N>_i<ms>.json plus its logs in <DIR>/logs; compare
+# two builds with: scale_report.py compare results/<old> results/<new>
+# Extra PHY options (channel model, ...) can be passed in PHY_ARGS.
+
+set -eu
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+APP=$(dirname "$HERE")
+NODES="1 4 8 16"
+INTERVALS="1000 100 20"
+DURATION=60
+CONN_INTERVAL=40
+DISCOVER_TIMEOUT=30
+OUT=""
+# Worst-case set-up of one node: the central's CONFIG_BT_CREATE_CONN_TIMEOUT plus
+# SETUP_STEPS * STEP_TIMEOUT (central/prj.conf, central/src/main.c)
+CONN_TIMEOUT=3
+SETUP_STEPS=6
+STEP_TIMEOUT=5
+NODE_SETUP=$((CONN_TIMEOUT + SETUP_STEPS * STEP_TIMEOUT))
+BOARD=${BOARD:-nrf52_bsim}
+BUILD=${BUILD_DIR:-$HERE/build}
+
+while getopts "n:i:d:c:o:" opt; do
+    case $opt in
+    n) NODES=$OPTARG ;;
+    i) INTERVALS=$OPTARG ;;
+    d) DURATION=$OPTARG ;;
+    c) CONN_INTERVAL=$OPTARG ;;
+    o) OUT=$OPTARG ;;
+    *) sed -n '2,18p' "$0"; exit 1 ;;
+    esac
+done
+
+: "${BSIM_OUT_PATH:?source the BabbleSim environment first}"
+: "${BSIM_COMPONENTS_PATH:?source the BabbleSim environment first}"
+PHY=$BSIM_OUT_PATH/bin/bs_2G4_phy_v1
+
+if [ -z "$OUT" ]; then
+    OUT=$HERE/results/$(git -C "$APP" describe --always --dirty 2>/dev/null || echo local)
+fi
+mkdir -p "$OUT/logs"
+
+west build -b "$BOARD" -d "$BUILD/peripheral" "$APP"
+west build -b "$BOARD" -d "$BUILD/central" "$HERE/central"
+PERIPHERAL=$BUILD/peripheral/zephyr/zephyr.exe
+CENTRAL=$BUILD/central/zephyr/zephyr.exe
+
+for n in $NODES; do
+    for i in $INTERVALS; do
+        name=n${n}_i${i}
+        sim_id=fw_scale_${name}_$$
+        logs=$OUT/logs/$name
+        # Discovery and worst-case sequential set-up come before the window; the
+        # central ends the run, so this only has to be long enough
+        sim_us=$(( (DISCOVER_TIMEOUT + NODE_SETUP * n + DURATION + 10) * 1000000 ))
+        mkdir -p "$logs"
+        echo "== $name"
+
+        "$CENTRAL" -s="$sim_id" -d=0 -rs=1000 -testid=central \
+            -argstest nodes="$n" interval_ms="$i" duration_s="$DURATION" \
+            conn_interval="$CONN_INTERVAL" discover_timeout_s="$DISCOVER_TIMEOUT" \
+            > "$logs/central.log" 2>&1 &
+        for d in $(seq 1 "$n"); do
+            # Distinct seeds give every node its own device address and timing
+            "$PERIPHERAL" -s="$sim_id" -d="$d" -rs="$d" > "$logs/node$d.log" 2>&1 &
+        done
+        (cd "$BSIM_OUT_PATH/bin" && "$PHY" -s="$sim_id" -D=$((n + 1)) -sim_length="$sim_us" \
+            ${PHY_ARGS:-}) > "$logs/phy.log" 2>&1 || true
+        wait || true
+
+        python3 "$HERE/scale_report.py" collect "$logs/central.log" "$OUT/$name.json" || true
+    done
+done
+
+python3 "$HERE/scale_report.py" table "$OUT" > "$OUT/summary.csv"
+echo "results in $OUT (summary.csv)"
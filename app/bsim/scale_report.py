@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""Reports for the BabbleSim scale test.
+
+    scale_report.py collect central.log out.json
+        Summarize the SCALE-RUN/SCALE-NODE lines of one central log.
+    scale_report.py table DIR [DIR ...]
+        One CSV row per run (all *.json in the directories).
+    scale_report.py compare OLD_DIR NEW_DIR
+        Per-metric change between two result sets, matched by node count
+        and sample interval.
+"""
+
+import csv
+import glob
+import json
+import os
+import statistics
+import sys
+
+METRICS = [
+    'discovered', 'ready', 'discovery_ms_p50', 'discovery_ms_max', 'setup_ms_mean',
+    'setup_ms_max', 'rate_hz', 'expected_hz', 'loss_pct', 'latency_ms_mean',
+    'latency_ms_max', 'disconnects',
+]
+# Metrics where a larger value is an improvement
+HIGHER_IS_BETTER = {'discovered', 'ready', 'rate_hz'}
+
+
+def summarize(run, nodes):
+    ready = [n for n in nodes if n['ready_ms'] >= 0]
+    disc = [n['discovered_ms'] for n in nodes]
+    setup = [n['setup_ms'] for n in nodes if n['setup_ms'] >= 0]
+    rx = sum(n['rx'] for n in ready)
+    lost = sum(n['lost'] for n in ready)
+    expected = sum(n['expected'] for n in ready)
+    window_s = run['window_ms'] / 1000.0
+
+    return {
+        'discovered': len(nodes),
+        'ready': len(ready),
+        'discovery_ms_p50': statistics.median(disc) if disc else None,
+        'discovery_ms_max': max(disc) if disc else None,
+        'setup_ms_mean': round(statistics.mean(setup), 1) if setup else None,
+        'setup_ms_max': max(setup) if setup else None,
+        'rate_hz': round(rx / window_s, 2) if window_s else None,
+        'expected_hz': round(len(ready) * 1000.0 / run['interval_ms'], 2),
+        'loss_pct': round(100.0 * lost / expected, 3) if expected else None,
+        'latency_ms_mean': round(sum(n['lat_sum_ms'] for n in ready) / rx, 1) if rx else None,
+        'latency_ms_max': max((n['lat_max_ms'] for n in ready), default=None),
+        'disconnects': sum(n['disconnects'] for n in nodes),
+    }
+
+
+def collect(log_path, out_path):
+    run, nodes = None, []
+    with open(log_path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            for tag in ('SCALE-RUN ', 'SCALE-NODE '):
+                pos = line.find(tag)
+                if pos < 0:
+                    continue
+                obj = json.loads(line[pos + len(tag):])
+                if tag == 'SCALE-RUN ':
+                    run = obj
+                else:
+                    nodes.append(obj)
+    if run is None:
+        sys.exit('%s: no SCALE-RUN line (central did not finish)' % log_path)
+
+    report = {'run': run, 'summary': summarize(run, nodes), 'nodes': nodes}
+    with open(out_path, 'w') as f:
+        json.dump(report, f, indent=1)
+    s = report['summary']
+    print('N=%d interval=%d ms: %d/%d ready, %s Hz of %s Hz, loss %s%%, latency %s ms'
+          % (run['nodes'], run['interval_ms'], s['ready'], run['nodes'], s['rate_hz'],
+             s['expected_hz'], s['loss_pct'], s['latency_ms_mean']))
+
+
+def load_dir(path):
+    runs = {}
+    for name in sorted(glob.glob(os.path.join(path, '*.json'))):
+        with open(name) as f:
+            rep = json.load(f)
+        runs[(rep['run']['nodes'], rep['run']['interval_ms'])] = rep
+    return runs
+
+
+def table(dirs):
+    out = csv.writer(sys.stdout)
+    out.writerow(['set', 'nodes', 'interval_ms', 'duration_s'] + METRICS)
+    for d in dirs:
+        for (nodes, interval), rep in sorted(load_dir(d).items()):
+            out.writerow([os.path.basename(os.path.normpath(d)), nodes, interval,
+                          rep['run']['duration_s']] + [rep['summary'][m] for m in METRICS])
+
+
+def compare(old_dir, new_dir):
+    old, new = load_dir(old_dir), load_dir(new_dir)
+    for key in sorted(set(old) & set(new)):
+        print('N=%d interval=%d ms' % key)
+        for m in METRICS:
+            a, b = old[key]['summary'][m], new[key]['summary'][m]
+            if a is None or b is None or a == b:
+                continue
+            worse = (b < a) if m in HIGHER_IS_BETTER else (b > a)
+            print('  %-18s %10s -> %-10s %s' % (m, a, b, 'worse' if worse else 'better'))
+    for key in sorted(set(old) ^ set(new)):
+        print('N=%d interval=%d ms: only in %s' % (key + (old_dir if key in old else new_dir,)))
+
+
+def main():
+    if len(sys.argv) == 4 and sys.argv[1] == 'collect':
+        collect(sys.argv[2], sys.argv[3])
+    elif len(sys.argv) >= 3 and sys.argv[1] == 'table':
+        table(sys.argv[2:])
+    elif len(sys.argv) == 4 and sys.argv[1] == 'compare':
+        compare(sys.argv[2], sys.argv[3])
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == '__main__':
+    main()
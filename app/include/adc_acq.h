@@ -0,0 +1,28 @@
+/*
+ * ADC acquisition backend
+ *
+ * Sampling requests are submitted with a completion callback. With
+ * CONFIG_APP_ADC_ACQ_ASYNC the conversion runs through adc_read_async() and
+ * the callback is invoked from the system workqueue once the completion
+ * signal fires, so the submitter never blocks on a conversion. With
+ * CONFIG_APP_ADC_ACQ_SYNC the read is done inline and the callback runs
+ * before adc_acq_submit() returns.
+ */
+
+#pragma once
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+
+/* err is the result of the read; seq->buffer holds the samples when err == 0 */
+typedef void (*adc_acq_done_t)(int err, void *user_data);
+
+/*
+ * Queue a read of seq on dev. The sequence and its buffer must stay valid and
+ * untouched until done runs. Returns -ENOMEM if the submission queue is full.
+ */
+int adc_acq_submit(const struct device *dev, const struct adc_sequence *seq,
+                   adc_acq_done_t done, void *user_data);
+
+/* Number of requests submitted but not yet completed */
+uint32_t adc_acq_pending(void);
@@ -0,0 +1,36 @@
+/*
+ * ADC self-calibration scheduler
+ *
+ * Decides when the next ADC read should carry an offset calibration instead
+ * of calibrating on every conversion: once at boot, then periodically, or
+ * early when die temperature or supply voltage has drifted since the last
+ * calibration. The first read after boot is a plain one that times an
+ * uncalibrated conversion; the boot calibration follows on the next read.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct adc_cal_stats {
+    uint32_t count;         /* calibrations performed since boot */
+    uint32_t total_us;      /* time spent calibrating since boot (estimated) */
+    uint32_t last_us;       /* cost of the last calibration (estimated) */
+    uint32_t read_avg_us;   /* average duration of a plain (uncalibrated) read */
+};
+
+/* Returns true if the next read should calibrate. mv is the latest converted value. */
+bool adc_cal_due(int32_t mv);
+
+/*
+ * Report a finished read so the scheduler can track timing and drift baselines.
+ * read_us is the conversion time only (submit to sampling done), without the
+ * time the completion spent waiting to be processed.
+ */
+void adc_cal_done(bool calibrated, uint32_t read_us, int32_t mv);
+
+/* Force a calibration on the next read (e.g. after the ADC was re-initialized) */
+void adc_cal_request(void);
+
+void adc_cal_stats_get(struct adc_cal_stats *stats);
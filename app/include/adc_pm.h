@@ -0,0 +1,29 @@
+/*
+ * ADC runtime power management
+ *
+ * Every scan takes a reference with adc_pm_get() and drops it with
+ * adc_pm_put(). The runtime PM reference on the ADC is only released
+ * CONFIG_APP_ADC_AUTOSUSPEND_MS after the last put, so scans in quick
+ * succession share one resume. The counters follow the device's runtime PM
+ * usage count: a resume is counted when it leaves 0, a suspend when it
+ * returns to 0.
+ */
+
+#pragma once
+
+#include <zephyr/device.h>
+#include <stdint.h>
+
+struct adc_pm_stats {
+    uint32_t gets;          /* references taken (scans and captures) */
+    uint32_t resumes;       /* suspended -> active transitions */
+    uint32_t suspends;      /* active -> suspended transitions */
+};
+
+/* Device whose runtime PM is managed; call before the first adc_pm_get() */
+void adc_pm_init(const struct device *dev);
+
+void adc_pm_get(void);
+void adc_pm_put(void);
+
+void adc_pm_stats_get(struct adc_pm_stats *stats);
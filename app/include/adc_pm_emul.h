@@ -0,0 +1,20 @@
+/*
+ * Emulated ADC with runtime PM (mycompany,adc-pm-emul)
+ *
+ * Front for a zephyr,adc-emul instance on native_sim. The counters are the
+ * PM actions the device has really received, the ground truth for the
+ * counters of adc_pm.c.
+ */
+
+#pragma once
+
+#include <zephyr/device.h>
+#include <stdint.h>
+
+struct adc_pm_emul_counts {
+    uint32_t resumes;       /* PM_DEVICE_ACTION_RESUME received */
+    uint32_t suspends;      /* PM_DEVICE_ACTION_SUSPEND received */
+    uint32_t rejected;      /* reads refused because the device was suspended */
+};
+
+void adc_pm_emul_counts_get(const struct device *dev, struct adc_pm_emul_counts *out);
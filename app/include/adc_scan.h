@@ -0,0 +1,33 @@
+/*
+ * Devicetree-driven ADC channel table
+ *
+ * The sampler scans every io-channels entry of one devicetree node in a single
+ * multi-channel ADC sequence. The node is the one labelled adc_scan (compatible
+ * "mycompany,adc-scan") when present, otherwise the vbatt node. Entry 0 is
+ * always the battery channel reported through the Voltage characteristic.
+ */
+
+#pragma once
+
+#include <zephyr/devicetree.h>
+
+#if DT_NODE_EXISTS(DT_NODELABEL(adc_scan))
+#define ADC_SCAN_NODE DT_NODELABEL(adc_scan)
+#else
+#define ADC_SCAN_NODE DT_NODELABEL(vbatt)
+#endif
+
+#if !DT_NODE_EXISTS(ADC_SCAN_NODE) || !DT_NODE_HAS_PROP(ADC_SCAN_NODE, io_channels)
+#error "No suitable devicetree overlay specified"
+#endif
+
+#define ADC_SCAN_NUM_CHANNELS DT_PROP_LEN(ADC_SCAN_NODE, io_channels)
+
+/* Human-readable name of entry idx (io-channel-names if given) */
+#define ADC_SCAN_CHAN_NAME(idx) \
+	COND_CODE_1(DT_PROP_HAS_IDX(ADC_SCAN_NODE, io_channel_names, idx), \
+		    (DT_PROP_BY_IDX(ADC_SCAN_NODE, io_channel_names, idx)), \
+		    ("ADC channel " #idx))
+
+/* Publish a converted value for channel idx >= 1 over BLE (channel 0 uses notify_voltage()) */
+void notify_channel(uint8_t idx, uint16_t mv);
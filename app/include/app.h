@@ -8,6 +8,8 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include "timer_svc.h"
 
 extern bool en_ble;
 extern uint16_t voltage_mv;
@@ -18,10 +20,31 @@ extern struct k_work_delayable led_error_work;
 extern struct k_work_delayable battery_voltage_work;
 extern struct k_work_delayable led_idle_work;
 
+/* Periodic tasks driven by the wakeup-coalescing timer service */
+extern struct timer_svc_task battery_task;
+extern struct timer_svc_task led_idle_task;
+
 int adc_init(void);
+/* Battery channel of the scan (entry 0), configured by adc_init() */
+const struct adc_dt_spec *adc_battery_channel(void);
+/* Stop periodic sampling and hold the ADC resumed, e.g. for transient capture */
+void adc_sampling_pause(void);
+void adc_sampling_resume(void);
+void adc_sampling_restart(void);
+/* Stop periodic sampling without touching the ADC, e.g. after a fault */
+void adc_sampling_stop(void);
+/* Re-configure the ADC channels in place and restart sampling */
+int adc_recover(void);
+void adc_set_sample_interval(uint32_t interval_ms);
+void adc_set_threshold(uint16_t mv);
 int led_init(void);
+void led_set_patterns(bool idle_blink, bool sample_blink);
+/* Leave the error pattern once every fault has been recovered */
+void led_error_clear(void);
 int button_init(void);
 void advertising_update(void);
+/* Push the active configuration record to the subsystems that use it */
+void app_config_apply(void);
 void sample_count_increment_and_save(void);
 int watchdog_init(void);
 
@@ -0,0 +1,58 @@
+/*
+ * Runtime configuration record
+ *
+ * Interval, threshold, BLE enable and reporting policy live in one versioned,
+ * CRC-protected record. It is read directly from its own flash partition
+ * (app_config_partition) at early init, without walking the settings backend,
+ * and rewritten atomically: the new record goes to the slot that does not hold
+ * the current one, so an interrupted write leaves the previous record intact.
+ * Boards without the partition keep the record under a settings key instead.
+ */
+
+#pragma once
+
+#include <zephyr/devicetree.h>
+#include <zephyr/toolchain.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Built-in defaults: devicetree app node first, Kconfig takes precedence */
+#if DT_NODE_EXISTS(DT_PATH(app)) && DT_NODE_HAS_PROP(DT_PATH(app), sample_interval_ms)
+#define DT_SAMPLE_INTERVAL_MS DT_PROP(DT_PATH(app), sample_interval_ms)
+#else
+#define DT_SAMPLE_INTERVAL_MS 1000
+#endif
+
+#if DT_NODE_EXISTS(DT_PATH(app)) && DT_NODE_HAS_PROP(DT_PATH(app), voltage_threshold_mv)
+#define DT_VOLTAGE_THRESHOLD_MV DT_PROP(DT_PATH(app), voltage_threshold_mv)
+#else
+#define DT_VOLTAGE_THRESHOLD_MV 3000
+#endif
+
+#define APP_CFG_VERSION 2
+
+/* Current layout (version 2). Also the wire format of the config characteristic. */
+struct app_cfg {
+    uint32_t sample_interval_ms;
+    uint16_t threshold_mv;
+    uint8_t en_ble;
+    uint8_t notify_every;       /* notify every Nth sample at full power; scaled by power profiles */
+} __packed;
+
+/* Read the record (or fall back to the built-in defaults). Call before adc_init(). */
+int app_config_init(void);
+
+/* Copy of the active configuration; always valid after app_config_init(). ISR-safe. */
+void app_config_get(struct app_cfg *out);
+
+/*
+ * Replace the active configuration and persist it after
+ * CONFIG_APP_CONFIG_SAVE_DELAY_MS, so bursts of changes cost one write.
+ * ISR-safe. Returns -EINVAL for an out-of-range record.
+ */
+int app_config_set(const struct app_cfg *cfg);
+
+/* Flip en_ble in the active record in one step and persist it like app_config_set().
+ * Returns the new value.
+ */
+bool app_config_toggle_en_ble(void);
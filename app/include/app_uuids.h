@@ -14,4 +14,50 @@
   BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef2)
 #define BT_UUID_SAMPLE_INTERVAL_CHAR  BT_UUID_DECLARE_128(BT_UUID_SAMPLE_INTERVAL_CHAR_VAL)
 
+#define BT_UUID_BOOT_PROFILE_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef3)
+#define BT_UUID_BOOT_PROFILE_CHAR  BT_UUID_DECLARE_128(BT_UUID_BOOT_PROFILE_CHAR_VAL)
+
+#define BT_UUID_POWER_MODE_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef4)
+#define BT_UUID_POWER_MODE_CHAR    BT_UUID_DECLARE_128(BT_UUID_POWER_MODE_CHAR_VAL)
+
+#define BT_UUID_ENERGY_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef5)
+#define BT_UUID_ENERGY_CHAR        BT_UUID_DECLARE_128(BT_UUID_ENERGY_CHAR_VAL)
+
+#define BT_UUID_TRANSIENT_CTRL_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef6)
+#define BT_UUID_TRANSIENT_CTRL_CHAR BT_UUID_DECLARE_128(BT_UUID_TRANSIENT_CTRL_CHAR_VAL)
+
+#define BT_UUID_TRANSIENT_DATA_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef7)
+#define BT_UUID_TRANSIENT_DATA_CHAR BT_UUID_DECLARE_128(BT_UUID_TRANSIENT_DATA_CHAR_VAL)
+
+#define BT_UUID_TIME_SYNC_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef8)
+#define BT_UUID_TIME_SYNC_CHAR     BT_UUID_DECLARE_128(BT_UUID_TIME_SYNC_CHAR_VAL)
+
+#define BT_UUID_SAMPLE_TS_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef9)
+#define BT_UUID_SAMPLE_TS_CHAR     BT_UUID_DECLARE_128(BT_UUID_SAMPLE_TS_CHAR_VAL)
+
+#define BT_UUID_FAULTS_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdefa)
+#define BT_UUID_FAULTS_CHAR        BT_UUID_DECLARE_128(BT_UUID_FAULTS_CHAR_VAL)
+
+#define BT_UUID_CONFIG_CHAR_VAL \
+  BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdefb)
+#define BT_UUID_CONFIG_CHAR        BT_UUID_DECLARE_128(BT_UUID_CONFIG_CHAR_VAL)
+
+/* Service carrying one characteristic per additional ADC scan channel. Channel
+ * idx (idx >= 1) uses BT_UUID_CHANNEL_CHAR_VAL(idx).
+ */
+#define BT_UUID_CHANNEL_SERVICE_VAL \
+  BT_UUID_128_ENCODE(0x12345679, 0x1234, 0x5678, 0x1234, 0x56789abcde00)
+#define BT_UUID_CHANNEL_SERVICE    BT_UUID_DECLARE_128(BT_UUID_CHANNEL_SERVICE_VAL)
+
+#define BT_UUID_CHANNEL_CHAR_VAL(idx) \
+  BT_UUID_128_ENCODE(0x12345679, 0x1234, 0x5678, 0x1234, 0x56789abcde00 + (idx))
+
 #endif /* APP_UUIDS_H__ */
\ No newline at end of file
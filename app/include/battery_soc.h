@@ -0,0 +1,25 @@
+/*
+ * Battery state-of-charge estimator
+ *
+ * Maps a load-compensated battery voltage onto a discharge curve. The curve
+ * comes from a devicetree node labelled battery_curve (compatible
+ * "mycompany,battery-curve") or from the built-in curve of the chemistry
+ * selected in Kconfig. Point and slope tables are generated at compile time;
+ * a lookup is a branch-free binary search plus one fixed-point multiply.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* State of charge in parts per ten thousand (0..10000) for a terminal voltage under load_ua */
+uint16_t battery_soc_pptt(int32_t mv, uint32_t load_ua);
+
+/* Estimate from a new sample using the configured load and publish it through BAS */
+void battery_soc_update(int32_t mv);
+
+/* Last estimate published by battery_soc_update() */
+uint16_t battery_soc_last_pptt(void);
+
+/* Average cost of battery_soc_pptt() in ns, measured over the samples so far */
+uint32_t battery_soc_avg_ns(void);
@@ -6,6 +6,21 @@
 
 #include <zephyr/types.h>
 
-int ble_init(void);
+/* Called once BLE bring-up has finished; err is non-zero if BLE is unavailable */
+typedef void (*ble_ready_cb_t)(int err);
+
+/* Start BLE bring-up asynchronously. ready_cb runs from the BT init context when done. */
+int ble_init(ble_ready_cb_t ready_cb);
 void ble_advertising_start(void);
-void notify_voltage(uint16_t mv);
\ No newline at end of file
+/* Restart the stack if its init failed, otherwise restart advertising.
+ * RECOVERY_IN_PROGRESS while init runs; bt_ready() then calls recovery_done().
+ */
+int ble_recover(void);
+void notify_voltage(uint16_t mv);
+/* Advertising interval in 0.625 ms units; restarts advertising if it is running */
+void ble_set_adv_interval(uint16_t min, uint16_t max);
+void notify_power_mode(uint8_t mode);
+/* Notify a sample of scan channel idx with its absolute time (Unix ms, 0 if unsynced) */
+void notify_sample(uint8_t idx, uint16_t mv, int64_t abs_ms);
+/* Send one chunk of a transient capture; -ENOTCONN if no client is subscribed */
+int notify_transient_chunk(const void *data, uint16_t len);
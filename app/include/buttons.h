@@ -0,0 +1,32 @@
+/*
+ * Button gesture engine
+ *
+ * The GPIO interrupt only timestamps the edge into a lock-free queue. A thread
+ * debounces by sampling the pin level once the edges have been quiet for
+ * CONFIG_APP_BUTTON_DEBOUNCE_DELAY_MS, then classifies press/release pairs into
+ * gestures and runs the action configured for each.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum button_gesture {
+    BUTTON_GESTURE_SHORT = 0,   /* released before CONFIG_APP_BUTTON_LONG_MS, no second press */
+    BUTTON_GESTURE_LONG,        /* released after CONFIG_APP_BUTTON_LONG_MS, before _HOLD_MS if hold has an action */
+    BUTTON_GESTURE_DOUBLE,      /* two short presses within CONFIG_APP_BUTTON_DOUBLE_MS */
+    BUTTON_GESTURE_HOLD,        /* still pressed after CONFIG_APP_BUTTON_HOLD_MS */
+    BUTTON_GESTURE_COUNT,
+};
+
+enum button_action {
+    BUTTON_ACTION_NONE = 0,
+    BUTTON_ACTION_TOGGLE_BLE,       /* toggle en_ble: sampling, notifications, advertising */
+    BUTTON_ACTION_DEMO_ERROR,       /* raise APP_ERR_BUTTON to demo the error pattern */
+    BUTTON_ACTION_TOGGLE_CAPTURE,   /* arm/disarm transient capture */
+    BUTTON_ACTION_REBOOT,
+    BUTTON_ACTION_COUNT,
+};
+
+/* Change the action of a gesture at runtime (defaults come from Kconfig) */
+void button_set_action(enum button_gesture gesture, enum button_action action);
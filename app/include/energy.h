@@ -0,0 +1,58 @@
+/*
+ * Per-subsystem energy and duty-cycle accounting
+ *
+ * Subsystems report when they switch on and off; the radio reports its
+ * advertising/connection state and event interval. Combined with the per-state
+ * current draws configured in Kconfig (CONFIG_APP_ENERGY_*), and with CPU
+ * active/idle time from the thread runtime statistics, this gives a running
+ * charge estimate in nAh.
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+enum energy_sub {
+    ENERGY_ADC = 0,
+    ENERGY_LED,
+    ENERGY_RADIO,
+    ENERGY_CPU,
+    ENERGY_SUB_COUNT,
+};
+
+enum energy_radio_state {
+    ENERGY_RADIO_OFF = 0,
+    ENERGY_RADIO_ADV,
+    ENERGY_RADIO_CONN,
+};
+
+struct energy_report {
+    uint64_t active_ms[ENERGY_SUB_COUNT];  /* radio: time advertising or connected */
+    uint32_t charge_nah[ENERGY_SUB_COUNT];
+    uint32_t radio_events;
+    uint64_t cpu_idle_ms;
+    uint32_t total_nah;
+};
+
+#if IS_ENABLED(CONFIG_APP_ENERGY_ACCOUNTING)
+
+/* Mark a switched subsystem (ADC, LED) on or off; repeated calls with the same state are ignored */
+void energy_set(enum energy_sub sub, bool on);
+
+/* Report the radio state and its event interval (advertising or connection interval) */
+void energy_radio_set(enum energy_radio_state state, uint32_t interval_us);
+
+void energy_report_get(struct energy_report *report);
+
+#else
+
+static inline void energy_set(enum energy_sub sub, bool on) { ARG_UNUSED(sub); ARG_UNUSED(on); }
+static inline void energy_radio_set(enum energy_radio_state state, uint32_t interval_us)
+{
+    ARG_UNUSED(state);
+    ARG_UNUSED(interval_us);
+}
+
+#endif /* CONFIG_APP_ENERGY_ACCOUNTING */
@@ -0,0 +1,16 @@
+/*
+ * Stack footprint report
+ *
+ * Prints one line per thread in the form
+ *     STACK <name> <size> <peak used>
+ * for scripts/stack_sizes.py, which turns the peaks of a stress run into a
+ * Kconfig fragment of stack sizes.
+ */
+
+#pragma once
+
+#if IS_ENABLED(CONFIG_APP_STACK_ANALYSIS)
+void footprint_stack_report(void);
+#else
+static inline void footprint_stack_report(void) {}
+#endif
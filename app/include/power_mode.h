@@ -0,0 +1,44 @@
+/*
+ * Battery-aware power mode manager
+ *
+ * Filters the battery voltage and moves between NORMAL, CONSERVE and CRITICAL
+ * with hysteresis. Each mode carries a profile for the sample interval,
+ * advertising interval, LED patterns and notification rate, applied on entry.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum power_mode {
+    PWR_MODE_NORMAL = 0,
+    PWR_MODE_CONSERVE,
+    PWR_MODE_CRITICAL,
+    PWR_MODE_COUNT,
+};
+
+struct power_profile {
+    uint32_t sample_interval_mult;  /* multiple of the configured sample interval */
+    uint16_t adv_interval_min;      /* advertising interval, 0.625 ms units */
+    uint16_t adv_interval_max;
+    bool led_idle;                  /* periodic idle blink */
+    bool led_sample;                /* double blink per sample */
+    uint8_t notify_every;           /* notify every Nth sample */
+};
+
+/*
+ * Set the configured (full-rate) sample interval and reporting policy and apply
+ * the active profile on top of them. Called at init and on configuration changes.
+ */
+void power_mode_init(uint32_t base_interval_ms, uint8_t notify_every);
+
+/* Feed a new battery reading (mV); may trigger a mode transition */
+void power_mode_update(int32_t mv);
+
+/* True if the current sample should be notified under the active profile */
+bool power_mode_notify_due(void);
+
+enum power_mode power_mode_get(void);
+const struct power_profile *power_mode_profile(void);
+const char *power_mode_name(enum power_mode mode);
@@ -0,0 +1,40 @@
+/*
+ * Fault recovery supervisor
+ *
+ * Each APP_ERR_* bit maps to a subsystem. When a fault is raised, the subsystem
+ * is quiesced and recovered in place after an exponential back-off. A successful
+ * recovery clears the error bit. A subsystem that keeps failing within
+ * CONFIG_APP_RECOVERY_STABLE_S of its last recovery exhausts its attempt budget,
+ * and the device is reset.
+ *
+ * A recover hook that only starts the work returns RECOVERY_IN_PROGRESS and
+ * reports the outcome later with recovery_done().
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Returned by a recover hook whose outcome arrives through recovery_done() */
+#define RECOVERY_IN_PROGRESS 1
+
+enum recovery_subsys {
+    RECOVERY_ADC = 0,
+    RECOVERY_BLE,
+    RECOVERY_LED,
+    RECOVERY_BUTTON,
+    RECOVERY_SUBSYS_COUNT,
+};
+
+struct recovery_stats {
+    uint32_t faults[RECOVERY_SUBSYS_COUNT];     /* fault episodes */
+    uint32_t recovered[RECOVERY_SUBSYS_COUNT];  /* successful in-place recoveries */
+};
+
+/* Start recovery for every subsystem in err_bits (APP_ERR_*) not already being recovered */
+void recovery_handle(uint32_t err_bits);
+
+/* Outcome of a recovery that returned RECOVERY_IN_PROGRESS; ignored otherwise. Any context. */
+void recovery_done(enum recovery_subsys subsys, int err);
+
+void recovery_stats_get(struct recovery_stats *stats);
@@ -0,0 +1,40 @@
+/*
+ * Time synchronization against a central's reference clock
+ *
+ * A central writes its reference time (Unix ms) over BLE. Each sync re-anchors
+ * the local-to-reference mapping; syncs at least CONFIG_APP_TIME_SYNC_MIN_SPAN_S
+ * apart also update a filtered estimate of the local clock drift, so samples
+ * taken between syncs still get corrected absolute timestamps.
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct time_sync_stats {
+    uint32_t syncs;             /* accepted reference writes */
+    int32_t drift_ppb;          /* reference minus local rate, parts per billion */
+    int32_t last_error_us;      /* prediction error at the last sync (local ahead > 0) */
+};
+
+/* Local timebase used for all sample timestamps */
+static inline int64_t time_sync_local_us(void)
+{
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+#if IS_ENABLED(CONFIG_APP_TIME_SYNC)
+/* Apply a reference time (Unix ms) received now */
+int time_sync_set(int64_t ref_ms);
+bool time_sync_is_synced(void);
+/* Absolute time (Unix ms) of a time_sync_local_us() value; 0 until the first sync */
+int64_t time_sync_abs_ms(int64_t local_us);
+void time_sync_stats_get(struct time_sync_stats *stats);
+#else
+static inline int time_sync_set(int64_t ref_ms) { ARG_UNUSED(ref_ms); return -ENOTSUP; }
+static inline bool time_sync_is_synced(void) { return false; }
+static inline int64_t time_sync_abs_ms(int64_t local_us) { ARG_UNUSED(local_us); return 0; }
+static inline void time_sync_stats_get(struct time_sync_stats *stats) { *stats = (struct time_sync_stats){0}; }
+#endif
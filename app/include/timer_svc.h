@@ -0,0 +1,63 @@
+/*
+ * Wakeup-coalescing timer service
+ *
+ * Periodic tasks register a period and a slack tolerance. Each task may run
+ * anywhere in [due - slack, due]; the service wakes at the earliest due time
+ * and runs every task whose window has opened by then, so tasks with unrelated
+ * phases share one CPU wakeup instead of waking the core separately. Runs
+ * pulled forward keep their phase, so the sharing repeats every period.
+ *
+ * Task callbacks run on the system workqueue and must not block for long.
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct timer_svc_task;
+
+typedef void (*timer_svc_fn_t)(struct timer_svc_task *task);
+
+struct timer_svc_task {
+    sys_snode_t node;
+    timer_svc_fn_t fn;
+    const char *name;
+    uint32_t period_ms;
+    uint32_t slack_ms;
+    int64_t due_ms;     /* latest uptime for the next run; it may run slack_ms earlier */
+    uint32_t runs;
+    bool diag;          /* left out of the statistics, e.g. the rate report itself */
+    bool registered;
+    bool active;
+};
+
+#define TIMER_SVC_TASK_DEFINE(_name, _fn) \
+    struct timer_svc_task _name = { .fn = (_fn), .name = #_name }
+
+/* Coalescing statistics, measured over the last report window; rates are in milli-events/s */
+struct timer_svc_stats {
+    uint32_t wakeups;           /* total service wakeups since boot */
+    uint32_t coalesced_mhz;     /* service wakeups */
+    uint32_t uncoalesced_mhz;   /* task runs: the wakeups without coalescing */
+};
+
+/*
+ * Start (or restart) a periodic task. The first run is due delay_ms from now,
+ * then every period_ms; each run may be brought forward by up to slack_ms to
+ * share a wakeup with another task. ISR-safe.
+ */
+void timer_svc_start(struct timer_svc_task *task, uint32_t period_ms, uint32_t slack_ms,
+                     uint32_t delay_ms);
+
+/* Stop a task; a run already in progress completes. ISR-safe. */
+void timer_svc_stop(struct timer_svc_task *task);
+
+/* Change period/slack of a task without changing its current due time */
+void timer_svc_set_period(struct timer_svc_task *task, uint32_t period_ms, uint32_t slack_ms);
+
+bool timer_svc_is_active(const struct timer_svc_task *task);
+
+void timer_svc_stats_get(struct timer_svc_stats *stats);
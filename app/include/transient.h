@@ -0,0 +1,37 @@
+/*
+ * Triggered transient capture
+ *
+ * While armed, the battery channel is sampled continuously at
+ * CONFIG_APP_TRANSIENT_INTERVAL_US into a pre-trigger ring. A level or slope
+ * trigger freezes a window of pre- and post-trigger samples, which is
+ * timestamped, converted to mV and queued for download over BLE. Periodic
+ * sampling is paused while capture is armed.
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRANSIENT_WINDOW (CONFIG_APP_TRANSIENT_PRE_SAMPLES + CONFIG_APP_TRANSIENT_POST_SAMPLES)
+
+/* Downloaded as-is (little-endian) in chunks over the transient data characteristic */
+struct transient_capture {
+    uint32_t trigger_ms;        /* uptime of the trigger sample */
+    int64_t trigger_abs_ms;     /* Unix ms of the trigger sample, 0 if the clock is unsynced */
+    uint32_t interval_us;       /* time between samples */
+    uint16_t pre_samples;       /* samples up to and including the trigger sample */
+    uint16_t post_samples;
+    uint16_t mv[TRANSIENT_WINDOW];
+} __packed;
+
+/* Arm or disarm capture mode */
+void transient_arm(bool arm);
+bool transient_is_armed(void);
+
+/* Captures lost because the download queue was full */
+uint32_t transient_dropped(void);
+
+/* Resume the download of queued captures (e.g. once a client subscribes) */
+void transient_download_kick(void);
@@ -0,0 +1,47 @@
+/*
+ * Task watchdog
+ *
+ * Subsystems register a channel with a deadline and check in from the code
+ * path that proves they make progress. A timer checks every channel and feeds
+ * the hardware watchdog only while all enabled channels are within their
+ * deadline. The first channel found stalled is recorded in RAM that survives
+ * the watchdog reset, and feeding stops.
+ */
+
+#pragma once
+
+#include <zephyr/sys/util.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WDT_CHAN_NAME_LEN 12
+
+/* Stall that caused the previous watchdog reset */
+struct wdt_stall {
+    char name[WDT_CHAN_NAME_LEN];
+    uint32_t last_run_ms;       /* uptime of the channel's last check-in */
+    uint32_t deadline_ms;
+    uint32_t detected_ms;       /* uptime at which the stall was detected */
+};
+
+#if IS_ENABLED(CONFIG_APP_WDT_ENABLE) && IS_ENABLED(CONFIG_WATCHDOG)
+/* Register an enabled channel; returns its id or -ENOMEM. Channels can register before watchdog_init(). */
+int wdt_chan_register(const char *name, uint32_t deadline_ms);
+void wdt_chan_checkin(int id);
+void wdt_chan_set_deadline(int id, uint32_t deadline_ms);
+/* Disabled channels are not checked, e.g. while their work is stopped on purpose */
+void wdt_chan_enable(int id, bool enable);
+/* True if the previous reset was caused by a stalled channel */
+bool wdt_last_stall(struct wdt_stall *stall);
+#else
+static inline int wdt_chan_register(const char *name, uint32_t deadline_ms)
+{
+    ARG_UNUSED(name);
+    ARG_UNUSED(deadline_ms);
+    return -ENOTSUP;
+}
+static inline void wdt_chan_checkin(int id) { ARG_UNUSED(id); }
+static inline void wdt_chan_set_deadline(int id, uint32_t deadline_ms) { ARG_UNUSED(id); ARG_UNUSED(deadline_ms); }
+static inline void wdt_chan_enable(int id, bool enable) { ARG_UNUSED(id); ARG_UNUSED(enable); }
+static inline bool wdt_last_stall(struct wdt_stall *stall) { ARG_UNUSED(stall); return false; }
+#endif
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Per-module RAM/ROM footprint from a GNU ld map file.
+
+Every input section in the map is attributed to the object it came from.
+Application objects are reported per source file (main.c, ble.c, ...), all
+other objects per library (libkernel.a, libsubsys__bluetooth__host.a, ...).
+A section counts as RAM if it is placed in a RAM region, and as ROM if it is
+placed or loaded (initialized data) in a flash region.
+
+Usage:
+    footprint.py build/zephyr/zephyr.map [--json out.json] [--top N]
+
+Two JSON reports can be compared with --diff old.json new.json.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+MEM_RE = re.compile(r'^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+OUT_RE = re.compile(r'^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address\s+0x([0-9a-fA-F]+))?')
+IN_RE = re.compile(r'^\s+(\S+)?\s*0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+OBJ_RE = re.compile(r'(?:^|/)([^/]+\.a)\(([^)]+)\)$')
+
+
+def parse_regions(lines):
+    """Memory Configuration block: name -> (origin, length)."""
+    regions = {}
+    in_block = False
+    for line in lines:
+        if line.startswith('Memory Configuration'):
+            in_block = True
+            continue
+        if in_block and line.startswith('Linker script and memory map'):
+            break
+        if in_block:
+            m = MEM_RE.match(line)
+            if m and m.group(1) != 'Name':
+                regions[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+    return regions
+
+
+def classify(addr, regions):
+    for name, (origin, length) in regions.items():
+        if origin <= addr < origin + length and length > 0:
+            upper = name.upper()
+            if 'FLASH' in upper or 'ROM' in upper:
+                return 'rom'
+            if 'RAM' in upper:
+                return 'ram'
+    return None
+
+
+def module_of(obj):
+    m = OBJ_RE.search(obj)
+    if not m:
+        return os.path.basename(obj)
+    lib, member = m.groups()
+    if lib == 'libapp.a':
+        return 'app/' + re.sub(r'\.obj$', '', member)
+    return lib
+
+
+def parse_map(path):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        lines = f.read().splitlines()
+
+    regions = parse_regions(lines)
+    if not regions:
+        sys.exit('no Memory Configuration block in ' + path)
+
+    modules = {}
+    out_load = None         # load address offset of the current output section
+    in_map = False
+    pending_name = None     # input section name on its own line (long names wrap)
+
+    for line in lines:
+        if line.startswith('Linker script and memory map'):
+            in_map = True
+            continue
+        if not in_map or not line.strip():
+            continue
+
+        if not line[0].isspace():
+            m = OUT_RE.match(line)
+            out_load = None
+            if m and m.group(4):
+                out_load = int(m.group(4), 16) - int(m.group(2), 16)
+            pending_name = None
+            continue
+
+        m = IN_RE.match(line)
+        if not m:
+            stripped = line.strip()
+            pending_name = stripped if stripped.startswith('.') or stripped == 'COMMON' else None
+            continue
+        name = m.group(1) or pending_name
+        pending_name = None
+        if not name or name.startswith('*'):
+            continue        # *fill* and linker-generated padding
+        addr, size, obj = int(m.group(2), 16), int(m.group(3), 16), m.group(4).strip()
+        if size == 0 or '(' not in obj and not obj.endswith('.obj'):
+            continue
+
+        mod = modules.setdefault(module_of(obj), {'ram': 0, 'rom': 0})
+        kind = classify(addr, regions)
+        if kind == 'ram':
+            mod['ram'] += size
+            # Initialized data also occupies flash for its load image
+            if out_load and classify(addr + out_load, regions) == 'rom' \
+                    and not name.startswith(('.bss', '.noinit', 'COMMON')):
+                mod['rom'] += size
+        elif kind == 'rom':
+            mod['rom'] += size
+    return modules
+
+
+def print_table(modules, top):
+    rows = sorted(modules.items(), key=lambda kv: (kv[1]['ram'], kv[1]['rom']), reverse=True)
+    total_ram = sum(v['ram'] for v in modules.values())
+    total_rom = sum(v['rom'] for v in modules.values())
+    print('%-48s %10s %10s' % ('module', 'RAM', 'ROM'))
+    for name, v in rows[:top] if top else rows:
+        print('%-48s %10d %10d' % (name, v['ram'], v['rom']))
+    app_ram = sum(v['ram'] for k, v in modules.items() if k.startswith('app/'))
+    app_rom = sum(v['rom'] for k, v in modules.items() if k.startswith('app/'))
+    print('%-48s %10d %10d' % ('(application)', app_ram, app_rom))
+    print('%-48s %10d %10d' % ('(total)', total_ram, total_rom))
+
+
+def print_diff(old, new):
+    print('%-48s %10s %10s' % ('module', 'dRAM', 'dROM'))
+    for name in sorted(set(old) | set(new)):
+        o = old.get(name, {'ram': 0, 'rom': 0})
+        n = new.get(name, {'ram': 0, 'rom': 0})
+        dram, drom = n['ram'] - o['ram'], n['rom'] - o['rom']
+        if dram or drom:
+            print('%-48s %+10d %+10d' % (name, dram, drom))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('map', nargs='?', help='linker map file (zephyr.map)')
+    parser.add_argument('--json', help='also write the report as JSON')
+    parser.add_argument('--top', type=int, default=0, help='only list the N largest modules')
+    parser.add_argument('--diff', nargs=2, metavar=('OLD', 'NEW'), help='compare two JSON reports')
+    args = parser.parse_args()
+
+    if args.diff:
+        with open(args.diff[0]) as f_old, open(args.diff[1]) as f_new:
+            print_diff(json.load(f_old), json.load(f_new))
+        return
+    if not args.map:
+        parser.error('a map file is required')
+
+    modules = parse_map(args.map)
+    print_table(modules, args.top)
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(modules, f, indent=1, sort_keys=True)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Derive Kconfig stack sizes from the stack peaks of a stress run.
+
+Reads the console output of a CONFIG_APP_STRESS (or CONFIG_APP_STACK_ANALYSIS)
+build, takes the highest "STACK <name> <size> <used>" value seen for every
+thread and writes a Kconfig fragment with peak + margin, rounded up to the
+stack alignment. Threads without a known stack option are listed as comments.
+
+Usage:
+    stack_sizes.py stress.log [-o stacks.conf] [--margin 25] [--min-margin 128]
+
+The build only applies a fragment when asked to: -DSTACKS_CONF=<file>.
+
+Only feed it a log from target hardware (stress.conf, or CONFIG_APP_STACK_ANALYSIS
+with CONFIG_APP_STACK_REPORT_INTERVAL_S). On native_sim and nrf52_bsim
+(ARCH_POSIX) every thread runs on a host pthread stack; the Zephyr stack
+buffer is almost untouched and the peaks say nothing about the target.
+"""
+
+import argparse
+import re
+import sys
+
+STACK_RE = re.compile(r'STACK\s+(.+?)\s+(\d+)\s+(\d+)\s*$')
+
+# Thread name -> stack size option
+SYMBOLS = {
+    'sysworkq': 'CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE',
+    'main': 'CONFIG_MAIN_STACK_SIZE',
+    'idle': 'CONFIG_IDLE_STACK_SIZE',
+    'logging': 'CONFIG_LOG_PROCESS_THREAD_STACK_SIZE',
+    'BT RX': 'CONFIG_BT_RX_STACK_SIZE',
+    'BT RX WQ': 'CONFIG_BT_RX_STACK_SIZE',
+    'BT TX': 'CONFIG_BT_HCI_TX_STACK_SIZE',
+    'BT LW WQ': 'CONFIG_BT_LONG_WQ_STACK_SIZE',
+    'button_tid': 'CONFIG_APP_BUTTON_STACK_SIZE',
+    'transient_tid': 'CONFIG_APP_TRANSIENT_STACK_SIZE',
+}
+
+ALIGN = 8
+
+
+def round_up(n, align):
+    return (n + align - 1) // align * align
+
+
+def parse(stream):
+    peaks = {}
+    for line in stream:
+        m = STACK_RE.search(line)
+        if not m:
+            continue
+        name, size, used = m.group(1), int(m.group(2)), int(m.group(3))
+        old = peaks.get(name, (size, 0))
+        peaks[name] = (size, max(old[1], used))
+    return peaks
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('log', help='console output of the stress run ("-" for stdin)')
+    parser.add_argument('-o', '--output', help='write the Kconfig fragment here (default: stdout)')
+    parser.add_argument('--margin', type=int, default=25, help='headroom in percent of the peak')
+    parser.add_argument('--min-margin', type=int, default=128, help='minimum headroom in bytes')
+    args = parser.parse_args()
+
+    if args.log == '-':
+        peaks = parse(sys.stdin)
+    else:
+        with open(args.log, encoding='utf-8', errors='replace') as f:
+            peaks = parse(f)
+    if not peaks:
+        sys.exit('no STACK lines found; was the build configured with CONFIG_APP_STACK_ANALYSIS?')
+
+    out = ['# Generated by scripts/stack_sizes.py: peak + max(%d%%, %d B)'
+           % (args.margin, args.min_margin)]
+    sizes = {}
+    saved = 0
+    for name, (size, used) in sorted(peaks.items()):
+        new = round_up(used + max(used * args.margin // 100, args.min_margin), ALIGN)
+        sym = SYMBOLS.get(name)
+        if sym is None:
+            out.append('# %s: %d / %d B used (no stack option)' % (name, used, size))
+            continue
+        # Several threads can share one option; size it for the largest
+        if sym in sizes and sizes[sym][0] >= new:
+            continue
+        sizes[sym] = (new, size, used, name)
+
+    for sym, (new, size, used, name) in sorted(sizes.items()):
+        out.append('# %s: peak %d of %d B' % (name, used, size))
+        out.append('%s=%d' % (sym, new))
+        saved += size - new
+        print('%-40s %6d -> %6d (peak %d)' % (sym, size, new, used), file=sys.stderr)
+    print('%-40s %+6d B' % ('RAM freed', saved), file=sys.stderr)
+
+    text = '\n'.join(out) + '\n'
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,146 @@
+/* ADC acquisition backend: asynchronous submission/completion queue with a synchronous fallback */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/logging/log.h>
+#include "adc_acq.h"
+
+LOG_MODULE_REGISTER(ADC_ACQ, CONFIG_APP_LOG_LEVEL);
+
+#if IS_ENABLED(CONFIG_APP_ADC_ACQ_ASYNC)
+
+struct acq_req {
+    const struct device *dev;
+    const struct adc_sequence *seq;
+    adc_acq_done_t done;
+    void *user_data;
+};
+
+/*
+ * Submission queue. The ADC converts one sequence at a time, so the head entry
+ * is the one in flight and the rest wait for it; completions are taken from the
+ * poll signal on the system workqueue.
+ */
+static struct acq_req sq[CONFIG_APP_ADC_ACQ_QUEUE_DEPTH];
+static uint32_t sq_head;
+static uint32_t sq_count;
+static struct k_spinlock sq_lock;
+
+static struct k_poll_signal done_sig = K_POLL_SIGNAL_INITIALIZER(done_sig);
+static struct k_poll_event done_evt = K_POLL_EVENT_STATIC_INITIALIZER(
+    K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &done_sig, 0);
+static struct k_work_poll done_work;
+static bool done_work_ready;
+
+static void start_head(void);
+
+static void complete(int err)
+{
+    struct acq_req req;
+    bool more;
+    k_spinlock_key_t key = k_spin_lock(&sq_lock);
+
+    req = sq[sq_head];
+    sq_head = (sq_head + 1) % ARRAY_SIZE(sq);
+    sq_count--;
+    more = sq_count > 0;
+    k_spin_unlock(&sq_lock, key);
+
+    req.done(err, req.user_data);
+
+    if (more) {
+        start_head();
+    }
+}
+
+static void done_work_handler(struct k_work *work)
+{
+    unsigned int signaled;
+    int result;
+
+    k_poll_signal_check(&done_sig, &signaled, &result);
+    if (!signaled) {
+        return;
+    }
+    k_poll_signal_reset(&done_sig);
+    done_evt.state = K_POLL_STATE_NOT_READY;
+
+    complete(result);
+}
+
+/* Start the conversion at the head of the queue and arm the completion poll */
+static void start_head(void)
+{
+    const struct acq_req *req = &sq[sq_head];
+    int err;
+
+    err = k_work_poll_submit(&done_work, &done_evt, 1, K_FOREVER);
+    if (err) {
+        LOG_ERR("completion poll submit failed (%d)", err);
+        complete(err);
+        return;
+    }
+
+    err = adc_read_async(req->dev, req->seq, &done_sig);
+    if (err) {
+        (void)k_work_poll_cancel(&done_work);
+        complete(err);
+    }
+}
+
+int adc_acq_submit(const struct device *dev, const struct adc_sequence *seq,
+                   adc_acq_done_t done, void *user_data)
+{
+    bool idle;
+    k_spinlock_key_t key = k_spin_lock(&sq_lock);
+
+    if (!done_work_ready) {
+        k_work_poll_init(&done_work, done_work_handler);
+        done_work_ready = true;
+    }
+    if (sq_count == ARRAY_SIZE(sq)) {
+        k_spin_unlock(&sq_lock, key);
+        return -ENOMEM;
+    }
+    sq[(sq_head + sq_count) % ARRAY_SIZE(sq)] = (struct acq_req){
+        .dev = dev, .seq = seq, .done = done, .user_data = user_data,
+    };
+    idle = (sq_count++ == 0);
+    k_spin_unlock(&sq_lock, key);
+
+    if (idle) {
+        start_head();
+    }
+    return 0;
+}
+
+uint32_t adc_acq_pending(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&sq_lock);
+    uint32_t count = sq_count;
+
+    k_spin_unlock(&sq_lock, key);
+    return count;
+}
+
+#else /* CONFIG_APP_ADC_ACQ_SYNC */
+
+static uint32_t in_flight;
+
+int adc_acq_submit(const struct device *dev, const struct adc_sequence *seq,
+                   adc_acq_done_t done, void *user_data)
+{
+    in_flight++;
+    int err = adc_read(dev, seq);
+
+    in_flight--;
+    done(err, user_data);
+    return 0;
+}
+
+uint32_t adc_acq_pending(void)
+{
+    return in_flight;
+}
+
+#endif /* CONFIG_APP_ADC_ACQ_ASYNC */
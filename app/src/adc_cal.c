@@ -0,0 +1,134 @@
+/* ADC calibration policy: calibrate at boot, periodically, or on temperature/supply drift */
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+#if IS_ENABLED(CONFIG_APP_ADC_CAL_TEMP)
+#include <zephyr/drivers/sensor.h>
+#endif
+#include "adc_cal.h"
+
+LOG_MODULE_REGISTER(ADC_CAL, CONFIG_APP_LOG_LEVEL);
+
+#define CAL_PERIOD_MS ((int64_t)CONFIG_APP_ADC_CAL_PERIOD_S * 1000)
+
+/* Calibrate on the first read after boot */
+static atomic_t cal_pending = ATOMIC_INIT(1);
+static int64_t last_cal_ms;
+static int32_t cal_mv;              /* converted value at the last calibration */
+static struct adc_cal_stats stats;
+/* A plain read has been timed; read_avg_us itself can be 0 on a coarse cycle counter */
+static bool read_avg_valid;
+
+#if IS_ENABLED(CONFIG_APP_ADC_CAL_TEMP)
+static const struct device *const temp_dev = DEVICE_DT_GET(DT_NODELABEL(temp));
+static int32_t cal_temp_mdeg;       /* die temperature at the last calibration */
+static int64_t last_temp_check_ms;
+
+static int read_die_temp(int32_t *mdeg)
+{
+    struct sensor_value val;
+    int err;
+
+    if (!device_is_ready(temp_dev)) {
+        return -ENODEV;
+    }
+    err = sensor_sample_fetch(temp_dev);
+    if (err) {
+        return err;
+    }
+    err = sensor_channel_get(temp_dev, SENSOR_CHAN_DIE_TEMP, &val);
+    if (err) {
+        return err;
+    }
+    *mdeg = val.val1 * 1000 + val.val2 / 1000;
+    return 0;
+}
+
+static bool temp_drifted(int64_t now)
+{
+    int32_t mdeg;
+
+    /* The die temperature moves slowly; don't pay for a measurement every sample */
+    if (now - last_temp_check_ms < (int64_t)CONFIG_APP_ADC_CAL_TEMP_CHECK_S * 1000) {
+        return false;
+    }
+    last_temp_check_ms = now;
+
+    if (read_die_temp(&mdeg)) {
+        return false;
+    }
+    if (abs(mdeg - cal_temp_mdeg) >= CONFIG_APP_ADC_CAL_TEMP_DELTA_C * 1000) {
+        LOG_DBG("die temp moved %d -> %d mC", cal_temp_mdeg, mdeg);
+        return true;
+    }
+    return false;
+}
+#endif /* CONFIG_APP_ADC_CAL_TEMP */
+
+bool adc_cal_due(int32_t mv)
+{
+    int64_t now = k_uptime_get();
+
+    /* Time one plain read first, so that the first calibration has a baseline to subtract */
+    if (!read_avg_valid) {
+        return false;
+    }
+    if (atomic_get(&cal_pending)) {
+        return true;
+    }
+    if (CAL_PERIOD_MS > 0 && now - last_cal_ms >= CAL_PERIOD_MS) {
+        return true;
+    }
+    if (CONFIG_APP_ADC_CAL_SUPPLY_DELTA_MV > 0 &&
+        abs(mv - cal_mv) >= CONFIG_APP_ADC_CAL_SUPPLY_DELTA_MV) {
+        LOG_DBG("supply moved %d -> %d mV", cal_mv, mv);
+        return true;
+    }
+#if IS_ENABLED(CONFIG_APP_ADC_CAL_TEMP)
+    if (temp_drifted(now)) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+void adc_cal_done(bool calibrated, uint32_t read_us, int32_t mv)
+{
+    if (!calibrated) {
+        /* Running average of plain reads (1/8 weight) to estimate the calibration overhead */
+        if (!read_avg_valid) {
+            stats.read_avg_us = read_us;
+            read_avg_valid = true;
+        } else {
+            stats.read_avg_us = stats.read_avg_us - (stats.read_avg_us >> 3) + (read_us >> 3);
+        }
+        return;
+    }
+
+    atomic_clear(&cal_pending);
+    last_cal_ms = k_uptime_get();
+    cal_mv = mv;
+#if IS_ENABLED(CONFIG_APP_ADC_CAL_TEMP)
+    (void)read_die_temp(&cal_temp_mdeg);
+    last_temp_check_ms = last_cal_ms;
+#endif
+
+    stats.count++;
+    stats.last_us = read_us > stats.read_avg_us ? read_us - stats.read_avg_us : 0;
+    stats.total_us += stats.last_us;
+    LOG_INF("calibrated #%u: ~%u us (total %u us)", stats.count, stats.last_us, stats.total_us);
+}
+
+void adc_cal_request(void)
+{
+    atomic_set(&cal_pending, 1);
+}
+
+void adc_cal_stats_get(struct adc_cal_stats *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,44 @@
+/* Constant input for scan channels wired to an emulated ADC (native_sim, nrf52_bsim) */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/init.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/logging/log.h>
+#include "adc_scan.h"
+
+LOG_MODULE_REGISTER(ADC_EMUL_IN, CONFIG_APP_LOG_LEVEL);
+
+struct emul_input {
+    const struct device *dev;
+    unsigned int chan;
+};
+
+/* The emulated ADC itself, also behind a mycompany,adc-pm-emul front */
+#define EMUL_CTLR(ctlr) \
+    COND_CODE_1(DT_NODE_HAS_COMPAT(ctlr, mycompany_adc_pm_emul), (DT_PHANDLE(ctlr, adc)), (ctlr))
+
+#define EMUL_INPUT_ENTRY(node, prop, idx)                                                     \
+    IF_ENABLED(DT_NODE_HAS_COMPAT(EMUL_CTLR(DT_IO_CHANNELS_CTLR_BY_IDX(node, idx)), zephyr_adc_emul), \
+               ({ .dev = DEVICE_DT_GET(EMUL_CTLR(DT_IO_CHANNELS_CTLR_BY_IDX(node, idx))),      \
+                  .chan = DT_IO_CHANNELS_INPUT_BY_IDX(node, idx) },))
+
+static const struct emul_input inputs[] = {
+    DT_FOREACH_PROP_ELEM(ADC_SCAN_NODE, io_channels, EMUL_INPUT_ENTRY)
+};
+
+static int adc_emul_input_init(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(inputs); i++) {
+        int err = adc_emul_const_value_set(inputs[i].dev, inputs[i].chan,
+                                           CONFIG_APP_ADC_EMUL_INPUT_MV);
+
+        if (err) {
+            LOG_WRN("%s ch%u: input not set (%d)", inputs[i].dev->name, inputs[i].chan, err);
+        }
+    }
+    return 0;
+}
+
+SYS_INIT(adc_emul_input_init, APPLICATION, 0);
@@ -0,0 +1,89 @@
+/* ADC runtime power management: deferred release and transition counters */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/logging/log.h>
+#include "adc_pm.h"
+
+LOG_MODULE_REGISTER(ADC_PM, CONFIG_APP_LOG_LEVEL);
+
+static const struct device *pm_dev;
+static K_MUTEX_DEFINE(pm_lock);
+static struct adc_pm_stats stats;
+static uint32_t refs;           /* outstanding adc_pm_get() calls */
+static bool held;               /* this module holds a runtime PM reference on pm_dev */
+
+static void release_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(release_work, release_work_handler);
+
+void adc_pm_init(const struct device *dev)
+{
+    pm_dev = dev;
+}
+
+void adc_pm_get(void)
+{
+    k_mutex_lock(&pm_lock, K_FOREVER);
+    stats.gets++;
+    refs++;
+    /* A pending release that has not run yet simply keeps the device resumed */
+    (void)k_work_cancel_delayable(&release_work);
+#if IS_ENABLED(CONFIG_PM_DEVICE_RUNTIME)
+    if (!held) {
+        /* Negative if runtime PM is not enabled on the device: no transitions then */
+        int usage = pm_device_runtime_usage(pm_dev);
+        int err = pm_device_runtime_get(pm_dev);
+
+        if (err < 0) {
+            LOG_ERR("Failed to resume ADC device (%d)", err);
+        } else {
+            held = true;
+            if (usage == 0) {
+                stats.resumes++;
+            }
+        }
+    }
+#endif
+    k_mutex_unlock(&pm_lock);
+}
+
+void adc_pm_put(void)
+{
+    k_mutex_lock(&pm_lock, K_FOREVER);
+    if (refs > 0 && --refs == 0) {
+#if IS_ENABLED(CONFIG_PM_DEVICE_RUNTIME)
+        k_work_reschedule(&release_work, K_MSEC(CONFIG_APP_ADC_AUTOSUSPEND_MS));
+#endif
+    }
+    k_mutex_unlock(&pm_lock);
+}
+
+static void release_work_handler(struct k_work *work)
+{
+#if IS_ENABLED(CONFIG_PM_DEVICE_RUNTIME)
+    k_mutex_lock(&pm_lock, K_FOREVER);
+    /* A get may have slipped in between the timeout and taking the lock */
+    if (refs == 0 && held) {
+        /* Synchronous, so the usage count below already reflects the suspend */
+        int err = pm_device_runtime_put(pm_dev);
+
+        if (err < 0) {
+            LOG_ERR("Failed to release ADC device (%d)", err);
+        } else {
+            held = false;
+            if (pm_device_runtime_usage(pm_dev) == 0) {
+                stats.suspends++;
+            }
+        }
+    }
+    k_mutex_unlock(&pm_lock);
+#endif
+}
+
+void adc_pm_stats_get(struct adc_pm_stats *out)
+{
+    k_mutex_lock(&pm_lock, K_FOREVER);
+    *out = stats;
+    k_mutex_unlock(&pm_lock);
+}
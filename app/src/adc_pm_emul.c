@@ -0,0 +1,129 @@
+/* Emulated ADC with runtime PM: counts PM actions and forwards conversions to adc-emul */
+
+#define DT_DRV_COMPAT mycompany_adc_pm_emul
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/logging/log.h>
+#include "adc_pm_emul.h"
+
+LOG_MODULE_REGISTER(ADC_PM_EMUL, CONFIG_APP_LOG_LEVEL);
+
+struct pm_emul_config {
+    const struct device *adc;
+};
+
+struct pm_emul_data {
+    struct adc_pm_emul_counts counts;
+    struct k_spinlock lock;
+};
+
+static void count(struct pm_emul_data *data, uint32_t *counter)
+{
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    (*counter)++;
+    k_spin_unlock(&data->lock, key);
+}
+
+static bool pm_emul_active(const struct device *dev)
+{
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+    enum pm_device_state state;
+
+    return pm_device_state_get(dev, &state) != 0 || state == PM_DEVICE_STATE_ACTIVE;
+#else
+    return true;
+#endif
+}
+
+static int pm_emul_channel_setup(const struct device *dev, const struct adc_channel_cfg *cfg)
+{
+    const struct pm_emul_config *config = dev->config;
+
+    return adc_channel_setup(config->adc, cfg);
+}
+
+/* A conversion on a suspended ADC is exactly the bug this device is there to catch */
+static int pm_emul_check(const struct device *dev)
+{
+    struct pm_emul_data *data = dev->data;
+
+    if (!pm_emul_active(dev)) {
+        count(data, &data->counts.rejected);
+        LOG_ERR("read while suspended");
+        return -EIO;
+    }
+    return 0;
+}
+
+static int pm_emul_read(const struct device *dev, const struct adc_sequence *seq)
+{
+    const struct pm_emul_config *config = dev->config;
+    int err = pm_emul_check(dev);
+
+    return err ? err : adc_read(config->adc, seq);
+}
+
+#if IS_ENABLED(CONFIG_ADC_ASYNC)
+static int pm_emul_read_async(const struct device *dev, const struct adc_sequence *seq,
+                              struct k_poll_signal *async)
+{
+    const struct pm_emul_config *config = dev->config;
+    int err = pm_emul_check(dev);
+
+    return err ? err : adc_read_async(config->adc, seq, async);
+}
+#endif
+
+static int pm_emul_action(const struct device *dev, enum pm_device_action action)
+{
+    struct pm_emul_data *data = dev->data;
+
+    switch (action) {
+    case PM_DEVICE_ACTION_RESUME:
+        count(data, &data->counts.resumes);
+        return 0;
+    case PM_DEVICE_ACTION_SUSPEND:
+        count(data, &data->counts.suspends);
+        return 0;
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static int pm_emul_init(const struct device *dev)
+{
+    const struct pm_emul_config *config = dev->config;
+
+    return device_is_ready(config->adc) ? 0 : -ENODEV;
+}
+
+void adc_pm_emul_counts_get(const struct device *dev, struct adc_pm_emul_counts *out)
+{
+    struct pm_emul_data *data = dev->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    *out = data->counts;
+    k_spin_unlock(&data->lock, key);
+}
+
+#define PM_EMUL_DEFINE(inst)                                                                \
+    static const struct adc_driver_api pm_emul_api_##inst = {                               \
+        .channel_setup = pm_emul_channel_setup,                                             \
+        .read = pm_emul_read,                                                               \
+        IF_ENABLED(CONFIG_ADC_ASYNC, (.read_async = pm_emul_read_async,))                   \
+        .ref_internal = DT_PROP(DT_INST_PHANDLE(inst, adc), ref_internal_mv),               \
+    };                                                                                      \
+    static const struct pm_emul_config pm_emul_config_##inst = {                            \
+        .adc = DEVICE_DT_GET(DT_INST_PHANDLE(inst, adc)),                                   \
+    };                                                                                      \
+    static struct pm_emul_data pm_emul_data_##inst;                                         \
+    PM_DEVICE_DT_INST_DEFINE(inst, pm_emul_action);                                         \
+    DEVICE_DT_INST_DEFINE(inst, pm_emul_init, PM_DEVICE_DT_INST_GET(inst),                  \
+                          &pm_emul_data_##inst, &pm_emul_config_##inst, POST_KERNEL,        \
+                          CONFIG_APP_ADC_PM_EMUL_INIT_PRIORITY, &pm_emul_api_##inst);
+
+DT_INST_FOREACH_STATUS_OKAY(PM_EMUL_DEFINE)
@@ -15,10 +15,22 @@
 #include <zephyr/sys/printk.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/logging/log.h>
-#include <zephyr/pm/device.h>
+#include <zephyr/pm/device_runtime.h>
 #include "app.h"
+#include "app_config.h"
 #include "app_events.h"
 #include "ble.h"
+#include "boot_prof.h"
+#include "adc_cal.h"
+#include "adc_scan.h"
+#include "adc_acq.h"
+#include "adc_pm.h"
+#include "power_mode.h"
+#include "energy.h"
+#include "battery_soc.h"
+#include "transient.h"
+#include "time_sync.h"
+#include "watchdog.h"
 // #include <nrfx_saadc.h>
 /* #include <helpers/nrfx_gppi.h> */
 
@@ -28,155 +40,398 @@ LOG_MODULE_REGISTER(ADC_SAMPLER, CONFIG_ADC_LOG_LEVEL);
 uint16_t voltage_mv = 0;
 uint16_t sample_interval_ms = 0;
 
-/* Prefer DT defaults first, then override with Kconfig values at init */
-#if DT_NODE_EXISTS(DT_PATH(app)) && DT_NODE_HAS_PROP(DT_PATH(app), sample_interval_ms)
-#define DT_SAMPLE_INTERVAL_MS DT_PROP(DT_PATH(app), sample_interval_ms)
-#else
-#define DT_SAMPLE_INTERVAL_MS 1000
-#endif
-
-#if DT_NODE_EXISTS(DT_PATH(app)) && DT_NODE_HAS_PROP(DT_PATH(app), voltage_threshold_mv)
-#define DT_VOLTAGE_THRESHOLD_MV DT_PROP(DT_PATH(app), voltage_threshold_mv)
-#else
-#define DT_VOLTAGE_THRESHOLD_MV 3000
-#endif
-
 /* Effective threshold used at runtime */
 static uint16_t voltage_threshold_mv = DT_VOLTAGE_THRESHOLD_MV;
 
-#if !DT_NODE_EXISTS(DT_PATH(vbatt)) || \
-	!DT_NODE_HAS_PROP(DT_PATH(vbatt), io_channels)
-#error "No suitable devicetree overlay specified"
-#endif
+/* One entry per io-channels element of ADC_SCAN_NODE, built at compile time */
+struct adc_chan {
+	const struct adc_dt_spec spec;
+	const char *name;
+	uint16_t threshold_mv;
+	uint8_t buf_idx;	/* position of this channel in the interleaved scan buffer */
+};
+
+#define ADC_CHAN_ENTRY(node, prop, idx)						\
+	{									\
+		.spec = ADC_DT_SPEC_GET_BY_IDX(node, idx),			\
+		.name = ADC_SCAN_CHAN_NAME(idx),				\
+		.threshold_mv = COND_CODE_1(DT_PROP_HAS_IDX(node, threshold_mv, idx), \
+					    (DT_PROP_BY_IDX(node, threshold_mv, idx)), \
+					    (DT_VOLTAGE_THRESHOLD_MV)),		\
+	},
+
+static struct adc_chan channels[] = {
+	DT_FOREACH_PROP_ELEM(ADC_SCAN_NODE, io_channels, ADC_CHAN_ENTRY)
+};
 
 /* Local variables */
-static uint16_t buf;
+/* Interleaved scan buffer: the ADC stores one sample per channel in ascending channel-id order */
+static int16_t buf[ADC_SCAN_NUM_CHANNELS];
 
 //declare a work item for sampling battery voltage 
 struct k_work_delayable battery_voltage_work;
-/* using adc_channel_setup_dt() to configure the ADC channel */
-static const struct adc_dt_spec adc_ch = ADC_DT_SPEC_GET_BY_IDX(DT_NODELABEL(vbatt), 0);
-/* Single ADC io-channel specified in devicetree (first entry). */
+
+//periodic trigger for battery_voltage_work, coalesced with other periodic wakeups
+static void battery_tick(struct timer_svc_task *task)
+{
+	k_work_reschedule(&battery_voltage_work, K_NO_WAIT);
+}
+
+TIMER_SVC_TASK_DEFINE(battery_task, battery_tick);
+/* Battery channel; all channels share its ADC (checked in adc_configure()) */
+static const struct adc_dt_spec *const batt = &channels[0].spec;
+
+static enum adc_action scan_sampled(const struct device *dev,
+				    const struct adc_sequence *seq, uint16_t sampling_index);
+
+/* Called by the driver as soon as the conversion (and its calibration) is done */
+static const struct adc_sequence_options sequence_opts = {
+	.callback = scan_sampled,
+};
 
 static struct adc_sequence sequence = {
-	.buffer = &buf,
+	.options = &sequence_opts,
+	.buffer = buf,
 	/* buffer size in bytes, not number of samples */
 	.buffer_size = sizeof(buf),
 };
 
+static int32_t channel_raw(const struct adc_chan *ch)
+{
+	int16_t raw = buf[ch->buf_idx];
+
+	return ch->spec.channel_cfg.differential ? (int32_t)raw : (int32_t)(uint16_t)raw;
+}
+
+/* Pipeline for a secondary (non-battery) channel of the scan */
+static void process_channel(uint8_t idx, int64_t t_ms)
+{
+	const struct adc_chan *ch = &channels[idx];
+	int32_t mv = channel_raw(ch);
+
+	if (adc_raw_to_millivolts_dt(&ch->spec, &mv) < 0) {
+		LOG_WRN("%s: mV N/A", ch->name);
+		return;
+	}
+	LOG_DBG("%s: %"PRId32" mV", ch->name, mv);
+	notify_channel(idx, (uint16_t)mv);
+	notify_sample(idx, (uint16_t)mv, t_ms);
+
+	if (mv < ch->threshold_mv) {
+		LOG_WRN("%s: %"PRId32" mV is below threshold", ch->name, mv);
+	}
+}
+
+/* Task watchdog channel: a scan must complete within two sample intervals plus a margin */
+static int adc_wdt_chan = -1;
+
+static uint32_t adc_wdt_deadline(void)
+{
+	return 2U * sample_interval_ms + CONFIG_APP_WDT_ADC_MARGIN_MS;
+}
+
+/* Set while transient capture owns the ADC; periodic sampling stays off until resumed */
+static bool sampling_paused;
 // Work function to measure battery voltage periodically with sample_interval_ms
+/* Set while a scan owns buf; cleared by scan_done() */
+static bool scan_in_flight;
+static uint32_t scan_start;
+/* Cycle count when the driver finished converting; set from the ADC interrupt */
+static volatile uint32_t scan_end;
+static volatile bool scan_end_valid;
+/* Local time at which the scan was started; all its samples share it */
+static int64_t scan_local_us;
+
+static void scan_done(int err, void *user_data);
+
+static enum adc_action scan_sampled(const struct device *dev,
+				    const struct adc_sequence *seq, uint16_t sampling_index)
+{
+	scan_end = k_cycle_get_32();
+	scan_end_valid = true;
+	return ADC_ACTION_CONTINUE;
+}
+
 void measure_battery_voltage(struct k_work *work)
 {
 	int err;
-	int32_t val_mv;
 
-	// Ensure the ADC device resumes before sampling when PM is enabled
-	if (IS_ENABLED(CONFIG_PM_DEVICE)) {
-		err = pm_device_action_run(adc_ch.dev, PM_DEVICE_ACTION_RESUME);
-		if (err < 0) {
-			LOG_ERR("Failed to resume ADC device (%d)", err);
-		}
+	// The previous scan is still converting into buf; skip this tick
+	if (scan_in_flight) {
+		LOG_DBG("scan still in flight, tick dropped");
+		return;
 	}
 
-	err = adc_read_dt(&adc_ch, &sequence);
+	// Hold a PM reference on the ADC for the duration of the scan
+	energy_set(ENERGY_ADC, true);
+	adc_pm_get();
+
+	// Only calibrate when the policy asks for it; a calibrated conversion costs far more
+	sequence.calibrate = adc_cal_due(voltage_mv);
+	scan_in_flight = true;
+	scan_end_valid = false;
+	scan_start = k_cycle_get_32();
+	scan_local_us = time_sync_local_us();
+
+	// One scan converts every channel into buf; the rest happens in scan_done()
+	err = adc_acq_submit(batt->dev, &sequence, scan_done, NULL);
 	if (err < 0) {
+		scan_in_flight = false;
+		adc_pm_put();
+		energy_set(ENERGY_ADC, false);
+		LOG_ERR("Could not submit read (%d)", err);
+		app_evt_raise(APP_ERR_ADC);
+	}
+}
+
+// Completion of a scan. Runs on the system workqueue (async backend) or inline (sync backend)
+static void scan_done(int err, void *user_data)
+{
+	int32_t val_mv;
+	/* Conversion time for the calibration estimate; excludes the workqueue latency of this call */
+	uint32_t read_us = k_cyc_to_us_floor32((scan_end_valid ? scan_end : k_cycle_get_32()) -
+					       scan_start);
+	/* Corrected absolute time of the scan; 0 until a central has synced the clock */
+	int64_t t_ms = time_sync_abs_ms(scan_local_us);
+
+	scan_in_flight = false;
+	if (err < 0) {
+		adc_pm_put();
+		energy_set(ENERGY_ADC, false);
 		printk("Could not read (%d)", err);
 		app_evt_raise(APP_ERR_ADC);
 		return;
 	}
+	boot_prof_mark(BOOT_STAGE_FIRST_SAMPLE);
+	wdt_chan_checkin(adc_wdt_chan);
 
-	/* Convert raw sample to signed/unsigned as needed */
-	if (adc_ch.channel_cfg.differential) {
-		val_mv = (int32_t)((int16_t)buf);
-	} else {
-		val_mv = (int32_t)buf;
+	/* Secondary channels: demultiplex, convert, threshold and publish */
+	for (uint8_t i = 1; i < ARRAY_SIZE(channels); i++) {
+		process_channel(i, t_ms);
 	}
+
+	/* Battery channel. Convert raw sample to signed/unsigned as needed */
+	val_mv = channel_raw(&channels[0]);
 	LOG_INF("raw=%"PRId32, val_mv);
 
 	/* Convert raw value to millivolts using ADC instance config */
-	err = adc_raw_to_millivolts_dt(&adc_ch, &val_mv);
+	err = adc_raw_to_millivolts_dt(batt, &val_mv);
 	if (err < 0) {
 		printk("Failed to convert to mV (%d)", err);
 		app_evt_raise(APP_ERR_ADC);
 		LOG_INF(" (mV N/A)\n");
 	} else {
+		adc_cal_done(sequence.calibrate, read_us, val_mv);
 		voltage_mv = (uint16_t)val_mv;
 		LOG_INF(", %"PRId32" mV\n", val_mv);
+		if (t_ms != 0) {
+			LOG_INF("sampled at %"PRId64" ms", t_ms);
+		}
+		power_mode_update(val_mv);
+		battery_soc_update(val_mv);
+		if (power_mode_notify_due()) {
 			notify_voltage((uint16_t)val_mv);
+			notify_sample(0, (uint16_t)val_mv, t_ms);
+		}
 			/* Increment and persist the sample counter on successful measurements */
 			sample_count_increment_and_save();
 	}
 
 	k_work_reschedule(&led_sample_work, K_NO_WAIT);// indicate a sample event by blinking the LED twice quickly
 
-	/* Hook battery algorithm here if desired, e.g.:
-		*   unsigned int pct = battery_level_pptt(val_mv, levels);
-		*/
-
-	if (val_mv < voltage_threshold_mv) {
+	if (val_mv < channels[0].threshold_mv) {
 		LOG_WRN("battery voltage: %d is below threshold\n",
 				val_mv);
 	}
 
-	// Suspend the ADC device to save power until next sampling when PM is enabled
-	if (IS_ENABLED(CONFIG_PM_DEVICE)) {
-		err = pm_device_action_run(adc_ch.dev, PM_DEVICE_ACTION_SUSPEND);
-		if (err < 0) {
-			LOG_ERR("Failed to suspend ADC device (%d)", err);
-		}
-	}
+	// Release the ADC; it suspends once no scan has needed it for the autosuspend delay
+	adc_pm_put();
+	energy_set(ENERGY_ADC, false);
 
-	// Reschedule the work again after sample_interval_ms
-	// Only if no error condition is present and notifications is enabled
-	if (!app_evt_has(APP_ERR_ANY) && en_ble) 
+	// Keep sampling every sample_interval_ms (via battery_task)
+	// Only if the ADC has no fault and notifications is enabled. ADC faults are
+	// recovered by the supervisor (recovery.c), which restarts sampling.
+	if (app_evt_has(APP_ERR_ADC) || !en_ble) 
 	{
-		k_work_reschedule(&battery_voltage_work, K_MSEC(sample_interval_ms));
+		adc_sampling_stop();
 	}
 }
 
+static int adc_configure(void);
+
 int adc_init(void)
 {
 	int err;
+	struct app_cfg cfg;
 
-	/* Initialize from Devicetree first */
-	sample_interval_ms = DT_SAMPLE_INTERVAL_MS;
-	voltage_threshold_mv = DT_VOLTAGE_THRESHOLD_MV;
+	app_config_get(&cfg);
+	/* The configuration record already resolved DT defaults, Kconfig overrides and stored values */
+	sample_interval_ms = (uint16_t)CLAMP(cfg.sample_interval_ms, 10, UINT16_MAX);
 
-	/* Then apply Kconfig overrides (take precedence) */
-#ifdef CONFIG_APP_SAMPLE_INTERVAL_MS
-	sample_interval_ms = CONFIG_APP_SAMPLE_INTERVAL_MS;
-#endif
-#ifdef CONFIG_APP_VOLTAGE_THRESHOLD_MV
-	voltage_threshold_mv = CONFIG_APP_VOLTAGE_THRESHOLD_MV;
+	k_work_init_delayable(&battery_voltage_work, measure_battery_voltage);
+	/* Scans and captures take their ADC power references through adc_pm.c */
+	adc_pm_init(batt->dev);
+
+	adc_set_threshold(cfg.threshold_mv);
+
+	power_mode_init(cfg.sample_interval_ms, cfg.notify_every);
+
+	// Registered even if configuration fails: the recovery supervisor disables it while it retries
+	adc_wdt_chan = wdt_chan_register("adc", adc_wdt_deadline());
+
+	err = adc_configure();
+	if (err) {
+		return err;
+	}
+	// sequence.calibrate is set per read by the calibration scheduler (adc_cal.c)
+
+	//take the first sample immediately, then periodically
+	boot_prof_mark(BOOT_STAGE_ADC_READY);
+	adc_sampling_restart();
+
+#if IS_ENABLED(CONFIG_APP_TRANSIENT_ARM_AT_BOOT)
+	transient_arm(true);
 #endif
+	return 0;
+}
 
-	k_work_init_delayable(&battery_voltage_work, measure_battery_voltage);
+// Device readiness, runtime PM and channel setup; also used to recover in place after a fault
+static int adc_configure(void)
+{
+	int err;
 
-	/* Configure the single ADC channel prior to sampling. */
-	if (adc_is_ready_dt(&adc_ch) == false) {
-		LOG_ERR("ADC device is not ready %s", adc_ch.dev->name);
-		return 1;
+	if (adc_is_ready_dt(batt) == false) {
+		LOG_ERR("ADC device is not ready %s", batt->dev->name);
+		return -ENODEV;
 	}
 
-	err = adc_channel_setup_dt(&adc_ch);
+#if IS_ENABLED(CONFIG_PM_DEVICE_RUNTIME)
+	/* Unless devicetree already did (zephyr,pm-device-runtime-auto), hand the ADC to runtime PM */
+	if (!pm_device_runtime_is_enabled(batt->dev)) {
+		err = pm_device_runtime_enable(batt->dev);
+		if (err < 0) {
+			LOG_WRN("ADC runtime PM not available (%d)", err);
+		}
+	}
+#endif
+
+	/* Configure every channel of the scan prior to sampling. */
+	err = adc_sequence_init_dt(batt, &sequence);
 	if (err < 0) {
-		LOG_ERR("%s: device not ready (%d)", adc_ch.dev->name, err);
+		LOG_ERR("Failed to initialize ADC sequence (%d)", err);
 		return err;
 	}
+	sequence.channels = 0;
 
-	// sequence.channels = BIT(adc_ch.channel_id);
-	// sequence.resolution = adc_ch.resolution;
-	// sequence.oversampling = adc_ch.oversampling;
-	sequence.calibrate = true;	
+	for (uint8_t i = 0; i < ARRAY_SIZE(channels); i++) {
+		const struct adc_dt_spec *spec = &channels[i].spec;
 
-	err = adc_sequence_init_dt(&adc_ch, &sequence);
-	if (err < 0) {
-		LOG_ERR("Failed to initialize ADC sequence (%d)", err);
+		/* A single sequence can only scan channels of one ADC with one resolution */
+		if (spec->dev != batt->dev || spec->resolution != batt->resolution ||
+		    spec->oversampling != batt->oversampling ||
+		    (sequence.channels & BIT(spec->channel_id)) != 0) {
+			LOG_ERR("channel %u cannot be scanned with channel 0", i);
+			return -EINVAL;
+		}
+
+		err = adc_channel_setup_dt(spec);
+		if (err < 0) {
+			LOG_ERR("%s: device not ready (%d)", spec->dev->name, err);
+			return err;
+		}
+		sequence.channels |= BIT(spec->channel_id);
+	}
+
+	/* Samples land in ascending channel-id order; find each channel's slot */
+	for (uint8_t i = 0; i < ARRAY_SIZE(channels); i++) {
+		channels[i].buf_idx = POPCOUNT(sequence.channels & BIT_MASK(channels[i].spec.channel_id));
+	}
+	return 0;
+}
+
+int adc_recover(void)
+{
+	int err;
+
+	// A scan still converting owns the sequence, and a transient capture's running
+	// read owns the ADC; re-configuring under either breaks it. Retry after the next back-off.
+	if (scan_in_flight || sampling_paused) {
+		return -EBUSY;
+	}
+	err = adc_configure();
+	if (err) {
 		return err;
 	}
+	// Recalibrate: whatever went wrong may have left the ADC in an unknown state
+	adc_cal_request();
+	if (en_ble) {
+		adc_sampling_restart();
+	}
+	return 0;
+}
+
+// Change the effective sampling period (power profiles); reported over BLE as the sample interval
+void adc_set_sample_interval(uint32_t interval_ms)
+{
+	sample_interval_ms = (uint16_t)CLAMP(interval_ms, 10, UINT16_MAX);
+	timer_svc_set_period(&battery_task, sample_interval_ms, CONFIG_APP_SAMPLE_INTERVAL_SLACK_MS);
+	wdt_chan_set_deadline(adc_wdt_chan, adc_wdt_deadline());
+}
+
+void adc_set_threshold(uint16_t mv)
+{
+	voltage_threshold_mv = mv;
+	/* The battery channel falls back to the app-wide threshold (DT, Kconfig or stored config) */
+	if (!DT_PROP_HAS_IDX(ADC_SCAN_NODE, threshold_mv, 0)) {
+		channels[0].threshold_mv = voltage_threshold_mv;
+	}
+}
 
-	//take the first sample immediately
+// Take a sample now, then every sample_interval_ms
+void adc_sampling_restart(void)
+{
+	// A capture's endless read holds the ADC lock; a scan now would block the workqueue.
+	// adc_sampling_resume() restarts sampling once the capture is done.
+	if (sampling_paused) {
+		return;
+	}
+	wdt_chan_enable(adc_wdt_chan, true);
 	k_work_reschedule(&battery_voltage_work, K_NO_WAIT);
+	timer_svc_start(&battery_task, sample_interval_ms, CONFIG_APP_SAMPLE_INTERVAL_SLACK_MS,
+			sample_interval_ms);
+}
 
-	return 0;
+const struct adc_dt_spec *adc_battery_channel(void)
+{
+	return batt;
+}
+
+void adc_sampling_stop(void)
+{
+	timer_svc_stop(&battery_task);
+	k_work_cancel_delayable(&battery_voltage_work);
+	// Stopped on purpose or handed to the recovery supervisor; not a stall
+	wdt_chan_enable(adc_wdt_chan, false);
+}
+
+void adc_sampling_pause(void)
+{
+	sampling_paused = true;
+	adc_sampling_stop();
+	// Let a scan that is already converting finish before the ADC is taken over
+	while (scan_in_flight) {
+		k_sleep(K_MSEC(1));
+	}
+	adc_pm_get();
+	energy_set(ENERGY_ADC, true);
+}
+
+void adc_sampling_resume(void)
+{
+	adc_pm_put();
+	energy_set(ENERGY_ADC, false);
+	sampling_paused = false;
+	if (!app_evt_has(APP_ERR_ADC) && en_ble) {
+		adc_sampling_restart();
+	}
 }
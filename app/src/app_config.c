@@ -0,0 +1,415 @@
+/* Versioned configuration record: direct flash read at boot, double-buffered atomic writes */
+
+#include <stddef.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+#include "app_config.h"
+#include "boot_prof.h"
+
+LOG_MODULE_REGISTER(APP_CONFIG, CONFIG_APP_LOG_LEVEL);
+
+#define CFG_MAGIC 0x43464731 /* "CFG1" */
+
+/* Version 1: no reporting policy yet */
+struct app_cfg_v1 {
+    uint32_t sample_interval_ms;
+    uint16_t threshold_mv;
+    uint8_t en_ble;
+} __packed;
+
+/* Stored record header; the crc covers the header fields before it and the payload */
+struct cfg_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t len;       /* payload bytes */
+    uint32_t seq;       /* incremented on every save; the newest valid slot wins */
+    uint32_t crc;
+} __packed;
+
+/* Header plus the largest payload, padded for the flash write block size */
+#define CFG_REC_SIZE ROUND_UP(sizeof(struct cfg_hdr) + sizeof(struct app_cfg), 8)
+
+struct cfg_rec {
+    struct cfg_hdr hdr;
+    uint8_t payload[CFG_REC_SIZE - sizeof(struct cfg_hdr)];
+};
+
+BUILD_ASSERT(sizeof(struct cfg_rec) == CFG_REC_SIZE);
+
+#define CFG_SLOTS 2
+
+static struct app_cfg active;
+static uint32_t active_seq;
+static int active_slot = -1;    /* slot holding the active record, -1 if none */
+static struct k_spinlock lock;
+
+static void save_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(save_work, save_work_handler);
+
+static void set_defaults(struct app_cfg *cfg)
+{
+    cfg->sample_interval_ms = DT_SAMPLE_INTERVAL_MS;
+    cfg->threshold_mv = DT_VOLTAGE_THRESHOLD_MV;
+    cfg->en_ble = DT_NODE_HAS_PROP(DT_PATH(app), enable_ble);
+    cfg->notify_every = 1;
+
+    /* Kconfig takes precedence over devicetree */
+#ifdef CONFIG_APP_SAMPLE_INTERVAL_MS
+    cfg->sample_interval_ms = CONFIG_APP_SAMPLE_INTERVAL_MS;
+#endif
+#ifdef CONFIG_APP_VOLTAGE_THRESHOLD_MV
+    cfg->threshold_mv = CONFIG_APP_VOLTAGE_THRESHOLD_MV;
+#endif
+    cfg->en_ble = IS_ENABLED(CONFIG_APP_ENABLE_BLE);
+}
+
+static bool cfg_valid(const struct app_cfg *cfg)
+{
+    return cfg->sample_interval_ms >= 10 && cfg->sample_interval_ms <= 600000 &&
+           cfg->threshold_mv >= 1000 && cfg->threshold_mv <= 6000 &&
+           cfg->en_ble <= 1 && cfg->notify_every >= 1;
+}
+
+static uint32_t rec_crc(const struct cfg_rec *rec)
+{
+    uint32_t crc = crc32_ieee((const uint8_t *)&rec->hdr, offsetof(struct cfg_hdr, crc));
+
+    return crc32_ieee_update(crc, rec->payload, rec->hdr.len);
+}
+
+/* Bring a stored payload of any known version up to the current layout */
+static int migrate(const struct cfg_rec *rec, struct app_cfg *out)
+{
+    set_defaults(out);
+
+    switch (rec->hdr.version) {
+    case 1: {
+        struct app_cfg_v1 v1;
+
+        if (rec->hdr.len != sizeof(v1)) {
+            return -EINVAL;
+        }
+        memcpy(&v1, rec->payload, sizeof(v1));
+        out->sample_interval_ms = v1.sample_interval_ms;
+        out->threshold_mv = v1.threshold_mv;
+        out->en_ble = v1.en_ble;
+        break;
+    }
+    case APP_CFG_VERSION:
+        if (rec->hdr.len != sizeof(*out)) {
+            return -EINVAL;
+        }
+        memcpy(out, rec->payload, sizeof(*out));
+        break;
+    default:
+        return -ENOTSUP;
+    }
+    return cfg_valid(out) ? 0 : -EINVAL;
+}
+
+static bool rec_ok(const struct cfg_rec *rec)
+{
+    return rec->hdr.magic == CFG_MAGIC && rec->hdr.len <= sizeof(rec->payload) &&
+           rec->hdr.crc == rec_crc(rec);
+}
+
+static void rec_build(struct cfg_rec *rec, const struct app_cfg *cfg, uint32_t seq)
+{
+    memset(rec, 0xff, sizeof(*rec));
+    rec->hdr.magic = CFG_MAGIC;
+    rec->hdr.version = APP_CFG_VERSION;
+    rec->hdr.len = sizeof(*cfg);
+    rec->hdr.seq = seq;
+    memcpy(rec->payload, cfg, sizeof(*cfg));
+    rec->hdr.crc = rec_crc(rec);
+}
+
+#if FIXED_PARTITION_EXISTS(app_config_partition)
+/*
+ * Dedicated partition: one erase page per slot. A save erases and writes the
+ * slot that does not hold the active record.
+ */
+#define CFG_AREA_ID FIXED_PARTITION_ID(app_config_partition)
+
+static const struct flash_area *cfg_fa;
+static size_t slot_size;
+
+/* Bytes checked at the end of a slot; saves only ever write its start */
+#define CFG_TAIL_CHECK 32
+
+/*
+ * A slot holds either an erased page or a record at its start. Anything else is
+ * left over from the flash layout before app_config_partition was carved from
+ * storage_partition: an old NVS sector, with data at the start and ATEs at the end.
+ */
+static bool slot_foreign(int slot)
+{
+    uint32_t head;
+    uint8_t tail[CFG_TAIL_CHECK];
+    off_t off = slot * slot_size;
+
+    if (flash_area_read(cfg_fa, off, &head, sizeof(head)) ||
+        flash_area_read(cfg_fa, off + slot_size - sizeof(tail), tail, sizeof(tail))) {
+        return false;
+    }
+    if (head != CFG_MAGIC && head != UINT32_MAX) {
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(tail); i++) {
+        if (tail[i] != 0xff) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * First boot after the layout change: the shrunk storage_partition still holds
+ * NVS sectors written for its old size, and its last sectors are now ours. Erase
+ * both once, before the settings backend mounts, instead of letting NVS recover
+ * from a half-missing sector ring. Stored settings (bonds, counters) are lost once.
+ */
+static int layout_migrate(void)
+{
+    bool foreign = false;
+    int err;
+
+    for (int slot = 0; slot < CFG_SLOTS; slot++) {
+        foreign |= slot_foreign(slot);
+    }
+    if (!foreign) {
+        return 0;
+    }
+    LOG_WRN("app_config_partition holds data from an older flash layout, erasing storage");
+    err = flash_area_erase(cfg_fa, 0, cfg_fa->fa_size);
+    if (err) {
+        return err;
+    }
+#if FIXED_PARTITION_EXISTS(storage_partition)
+    const struct flash_area *storage_fa;
+
+    err = flash_area_open(FIXED_PARTITION_ID(storage_partition), &storage_fa);
+    if (err) {
+        return err;
+    }
+    err = flash_area_erase(storage_fa, 0, storage_fa->fa_size);
+    flash_area_close(storage_fa);
+#endif
+    return err;
+}
+
+static int backend_init(void)
+{
+    struct flash_pages_info info;
+    int err = flash_area_open(CFG_AREA_ID, &cfg_fa);
+
+    if (err) {
+        return err;
+    }
+    err = flash_get_page_info_by_offs(flash_area_get_device(cfg_fa), cfg_fa->fa_off, &info);
+    if (err) {
+        return err;
+    }
+    slot_size = info.size;
+    if (cfg_fa->fa_size < CFG_SLOTS * slot_size) {
+        LOG_ERR("app_config_partition needs %u pages", CFG_SLOTS);
+        return -ENOSPC;
+    }
+    return layout_migrate();
+}
+
+static int slot_read(int slot, struct cfg_rec *rec)
+{
+    return flash_area_read(cfg_fa, slot * slot_size, rec, sizeof(*rec));
+}
+
+static int slot_write(int slot, const struct cfg_rec *rec)
+{
+    int err = flash_area_erase(cfg_fa, slot * slot_size, slot_size);
+
+    if (err) {
+        return err;
+    }
+    return flash_area_write(cfg_fa, slot * slot_size, rec, sizeof(*rec));
+}
+
+#elif IS_ENABLED(CONFIG_SETTINGS)
+/*
+ * Settings fallback: the two slots are the keys appcfg/0 and appcfg/1. Only
+ * that subtree is loaded, but the backend may still have to be scanned.
+ */
+#define CFG_KEY "appcfg"
+
+static struct cfg_rec loaded[CFG_SLOTS];
+
+static int load_direct_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
+                          void *param)
+{
+    int slot = (key && key[0] >= '0' && key[0] < '0' + CFG_SLOTS && key[1] == '\0') ?
+               key[0] - '0' : -1;
+
+    if (slot < 0 || len != sizeof(struct cfg_rec)) {
+        return 0;
+    }
+    return MIN(read_cb(cb_arg, &loaded[slot], sizeof(loaded[slot])), 0);
+}
+
+static int backend_init(void)
+{
+    int err = settings_subsys_init();
+
+    if (err) {
+        return err;
+    }
+    memset(loaded, 0, sizeof(loaded));
+    return settings_load_subtree_direct(CFG_KEY, load_direct_cb, NULL);
+}
+
+static int slot_read(int slot, struct cfg_rec *rec)
+{
+    *rec = loaded[slot];
+    return 0;
+}
+
+static int slot_write(int slot, const struct cfg_rec *rec)
+{
+    char key[] = CFG_KEY "/0";
+    int err;
+
+    key[sizeof(key) - 2] = '0' + slot;
+    err = settings_save_one(key, rec, sizeof(*rec));
+    if (!err) {
+        loaded[slot] = *rec;
+    }
+    return err;
+}
+
+#else
+/* No persistent storage: the defaults apply on every boot */
+static int backend_init(void)
+{
+    return -ENOTSUP;
+}
+
+static int slot_read(int slot, struct cfg_rec *rec)
+{
+    return -ENOTSUP;
+}
+
+static int slot_write(int slot, const struct cfg_rec *rec)
+{
+    return -ENOTSUP;
+}
+#endif
+
+int app_config_init(void)
+{
+    struct cfg_rec rec;
+    uint16_t version = 0;
+    int err;
+
+    set_defaults(&active);
+
+    err = backend_init();
+    if (err) {
+        LOG_WRN("config storage unavailable (%d), using defaults", err);
+        return err;
+    }
+
+    for (int slot = 0; slot < CFG_SLOTS; slot++) {
+        struct app_cfg cfg;
+
+        if (slot_read(slot, &rec) || !rec_ok(&rec)) {
+            continue;
+        }
+        if (active_slot >= 0 && (int32_t)(rec.hdr.seq - active_seq) <= 0) {
+            continue;
+        }
+        if (migrate(&rec, &cfg)) {
+            LOG_WRN("config slot %d: version %u not usable", slot, rec.hdr.version);
+            continue;
+        }
+        active = cfg;
+        active_seq = rec.hdr.seq;
+        active_slot = slot;
+        version = rec.hdr.version;
+    }
+    boot_prof_mark(BOOT_STAGE_CONFIG_LOADED);
+
+    if (active_slot < 0) {
+        LOG_INF("no stored config, using defaults");
+        return 0;
+    }
+    LOG_INF("config v%u loaded from slot %d (seq %u)", version, active_slot, active_seq);
+    if (version != APP_CFG_VERSION) {
+        /* Rewrite in the current layout; the old record stays until that succeeds */
+        k_work_reschedule(&save_work, K_NO_WAIT);
+    }
+    return 0;
+}
+
+/* Readers run on the BT RX thread, the button thread and the workqueue; never hand out &active */
+void app_config_get(struct app_cfg *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    *out = active;
+    k_spin_unlock(&lock, key);
+}
+
+int app_config_set(const struct app_cfg *cfg)
+{
+    if (!cfg_valid(cfg)) {
+        return -EINVAL;
+    }
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    active = *cfg;
+    k_spin_unlock(&lock, key);
+    k_work_reschedule(&save_work, K_MSEC(CONFIG_APP_CONFIG_SAVE_DELAY_MS));
+    return 0;
+}
+
+bool app_config_toggle_en_ble(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool en = !active.en_ble;
+
+    active.en_ble = en;
+    k_spin_unlock(&lock, key);
+    k_work_reschedule(&save_work, K_MSEC(CONFIG_APP_CONFIG_SAVE_DELAY_MS));
+    return en;
+}
+
+static void save_work_handler(struct k_work *work)
+{
+    static struct cfg_rec rec;
+    static struct cfg_rec check;
+    struct app_cfg cfg;
+    /* Never overwrite the slot holding the active record */
+    int slot = active_slot < 0 ? 0 : (active_slot + 1) % CFG_SLOTS;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    cfg = active;
+    k_spin_unlock(&lock, key);
+
+    rec_build(&rec, &cfg, active_seq + 1);
+    int err = slot_write(slot, &rec);
+
+    /* Only switch over once the new record reads back intact */
+    if (!err && (slot_read(slot, &check) || memcmp(&check, &rec, sizeof(rec)) != 0)) {
+        err = -EIO;
+    }
+    if (err) {
+        LOG_ERR("config save to slot %d failed (%d)", slot, err);
+        return;
+    }
+    active_seq++;
+    active_slot = slot;
+    LOG_INF("config saved to slot %d (seq %u)", slot, active_seq);
+}
@@ -5,6 +5,7 @@
 #include <zephyr/sys/atomic.h>
 #include "app.h"
 #include "app_events.h"
+#include "recovery.h"
 
 LOG_MODULE_REGISTER(APP_EVENTS, CONFIG_APP_LOG_LEVEL);
 
@@ -18,15 +19,18 @@ static void app_evt_work_handler(struct k_work *work)
     if (err) {
         LOG_ERR("App error bits: 0x%08x", err);
 
-        /* Stop periodic/status works promptly */
+        /* Switch the status LED to the error pattern until every fault is recovered */
+        timer_svc_stop(&led_idle_task);
         k_work_cancel_delayable(&led_sample_work);
         k_work_cancel_delayable(&led_idle_work);
-        k_work_cancel_delayable(&battery_voltage_work);
 
         if (!app_evt_has(APP_ERR_LED))//make sure there are no errors from initializing LEDs before trying to blink the LED
         {
             k_work_reschedule(&led_error_work, K_NO_WAIT); //trigger a quick blink of status LED to indicate error  
         }
+
+        /* Faulted subsystems are restarted in place; the others keep running */
+        recovery_handle(err);
     } else {
         /* No errors; ensure periodic works are running */
     }
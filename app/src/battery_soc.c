@@ -0,0 +1,151 @@
+/* Battery state-of-charge: compile-time discharge tables and fixed-point interpolation */
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+#if IS_ENABLED(CONFIG_BT_BAS)
+#include <zephyr/bluetooth/services/bas.h>
+#endif
+#include "battery_soc.h"
+
+LOG_MODULE_REGISTER(BATT_SOC, CONFIG_APP_LOG_LEVEL);
+
+/*
+ * Curve accessors: CURVE_LEN points, CURVE_MV(i) / CURVE_PPTT(i) from full to
+ * empty. All of them are integer constant expressions so that the point and
+ * slope tables below are built by the compiler.
+ */
+#if DT_NODE_EXISTS(DT_NODELABEL(battery_curve))
+#define CURVE_NODE DT_NODELABEL(battery_curve)
+#define CURVE_LEN DT_PROP_LEN(CURVE_NODE, ocv_mv)
+#define CURVE_MV(i) DT_PROP_BY_IDX(CURVE_NODE, ocv_mv, i)
+#define CURVE_PPTT(i) DT_PROP_BY_IDX(CURVE_NODE, soc_pptt, i)
+BUILD_ASSERT(DT_PROP_LEN(CURVE_NODE, soc_pptt) == CURVE_LEN,
+             "battery_curve: ocv-mv and soc-pptt must have the same length");
+#else
+
+#if IS_ENABLED(CONFIG_APP_BATT_CHEM_LIFEPO4)
+#define CURVE_LEN 9
+#define CURVE_MV_LIST   3600, 3400, 3350, 3320, 3300, 3270, 3200, 3000, 2500
+#define CURVE_PPTT_LIST 10000, 9500, 9000, 7000, 5000, 3000, 2000, 1000, 0
+#elif IS_ENABLED(CONFIG_APP_BATT_CHEM_ALKALINE_2S)
+#define CURVE_LEN 8
+#define CURVE_MV_LIST   3200, 3000, 2800, 2600, 2400, 2200, 2000, 1800
+#define CURVE_PPTT_LIST 10000, 9000, 7500, 5500, 3500, 2000, 900, 0
+#else /* CONFIG_APP_BATT_CHEM_LIPO */
+#define CURVE_LEN 12
+#define CURVE_MV_LIST   4200, 4100, 4000, 3930, 3870, 3820, 3790, 3760, 3730, 3680, 3500, 3000
+#define CURVE_PPTT_LIST 10000, 9000, 8000, 7000, 6000, 5000, 4000, 3000, 2000, 1000, 500, 0
+#endif
+
+/* Expand the list argument before GET_ARG_N pastes the index */
+#define CURVE_ARG(n, ...) GET_ARG_N(n, __VA_ARGS__)
+#define CURVE_MV(i) CURVE_ARG(UTIL_INC(i), CURVE_MV_LIST)
+#define CURVE_PPTT(i) CURVE_ARG(UTIL_INC(i), CURVE_PPTT_LIST)
+#endif
+
+BUILD_ASSERT(CURVE_LEN >= 2, "battery curve needs at least two points");
+
+#define CURVE_MV_ENTRY(i, _) CURVE_MV(i)
+#define CURVE_PPTT_ENTRY(i, _) CURVE_PPTT(i)
+/* pptt per mV of segment i (between points i and i + 1), Q16 */
+#define CURVE_SLOPE_ENTRY(i, _)                                                   \
+    (((CURVE_PPTT(i) - CURVE_PPTT(UTIL_INC(i))) << 16) /                          \
+     (CURVE_MV(i) - CURVE_MV(UTIL_INC(i))))
+
+static const int32_t curve_mv[] = { LISTIFY(CURVE_LEN, CURVE_MV_ENTRY, (,)) };
+static const int32_t curve_pptt[] = { LISTIFY(CURVE_LEN, CURVE_PPTT_ENTRY, (,)) };
+static const int32_t curve_slope_q16[] = { LISTIFY(UTIL_DEC(CURVE_LEN), CURVE_SLOPE_ENTRY, (,)) };
+
+static uint16_t last_pptt;
+static uint8_t last_pct = UINT8_MAX;
+static uint64_t bench_cycles;
+static uint32_t bench_calls;
+
+uint16_t battery_soc_pptt(int32_t mv, uint32_t load_ua)
+{
+    /* Open-circuit estimate: add back the drop across the internal resistance */
+    int32_t ocv = mv + (int32_t)(((uint64_t)load_ua * CONFIG_APP_BATT_R_INT_MOHM) / 1000000U);
+
+    if (ocv >= curve_mv[0]) {
+        return curve_pptt[0];
+    }
+    if (ocv <= curve_mv[CURVE_LEN - 1]) {
+        return curve_pptt[CURVE_LEN - 1];
+    }
+
+    /* Branch-free search for the segment i with curve_mv[i] > ocv >= curve_mv[i + 1] */
+    uint32_t i = 0;
+    uint32_t n = CURVE_LEN - 1;
+
+    while (n > 1) {
+        uint32_t half = n / 2;
+
+        i = (curve_mv[i + half] > ocv) ? i + half : i;
+        n -= half;
+    }
+
+    /* (ocv - mv[i + 1]) is at most the segment width, so the product fits 32 bits */
+    return (uint16_t)(curve_pptt[i + 1] +
+                      (((uint32_t)(ocv - curve_mv[i + 1]) * (uint32_t)curve_slope_q16[i]) >> 16));
+}
+
+void battery_soc_update(int32_t mv)
+{
+    uint32_t start = k_cycle_get_32();
+    uint16_t pptt = battery_soc_pptt(mv, CONFIG_APP_BATT_LOAD_UA);
+
+    bench_cycles += k_cycle_get_32() - start;
+    bench_calls++;
+
+    last_pptt = pptt;
+    uint8_t pct = (uint8_t)((pptt + 50) / 100);
+
+    if (pct == last_pct) {
+        return;
+    }
+    last_pct = pct;
+    LOG_INF("battery %u.%02u%%", pptt / 100, pptt % 100);
+#if IS_ENABLED(CONFIG_BT_BAS)
+    /* Notifies subscribed Battery Service clients */
+    (void)bt_bas_set_battery_level(pct);
+#endif
+}
+
+uint16_t battery_soc_last_pptt(void)
+{
+    return last_pptt;
+}
+
+uint32_t battery_soc_avg_ns(void)
+{
+    if (bench_calls == 0) {
+        return 0;
+    }
+    return (uint32_t)(k_cyc_to_ns_floor64(bench_cycles) / bench_calls);
+}
+
+#if IS_ENABLED(CONFIG_APP_BATT_SOC_BENCH)
+/* Sweep the whole curve once at boot to measure the lookup cost independently of sampling */
+static int battery_soc_bench(void)
+{
+    const int32_t lo = curve_mv[CURVE_LEN - 1] - 100;
+    const int32_t hi = curve_mv[0] + 100;
+    uint32_t calls = 0;
+    uint32_t sink = 0;
+    uint32_t start = k_cycle_get_32();
+
+    for (int32_t mv = lo; mv <= hi; mv++) {
+        sink += battery_soc_pptt(mv, CONFIG_APP_BATT_LOAD_UA);
+        calls++;
+    }
+    uint64_t ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+    LOG_INF("soc bench: %u lookups, %u ns/lookup (checksum %u)", calls,
+            (uint32_t)(ns / calls), sink);
+    return 0;
+}
+
+SYS_INIT(battery_soc_bench, APPLICATION, 99);
+#endif
@@ -1,9 +1,11 @@
+#include <string.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/hci.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/settings/settings.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/kernel.h>
 
 #include <zephyr/logging/log.h>
@@ -11,8 +13,16 @@ LOG_MODULE_REGISTER(BLE_MOD, CONFIG_APP_LOG_LEVEL);
 
 #include "app.h"
 #include "app_uuids.h"
+#include "app_config.h"
 #include "ble.h"
 #include "app_events.h"
+#include "boot_prof.h"
+#include "adc_scan.h"
+#include "power_mode.h"
+#include "energy.h"
+#include "transient.h"
+#include "time_sync.h"
+#include "recovery.h"
 
 #define DEVICE_NAME             CONFIG_APP_BLE_DEVICE_NAME
 #define DEVICE_NAME_LEN         (sizeof(DEVICE_NAME) - 1)
@@ -27,6 +37,11 @@ LOG_MODULE_REGISTER(BLE_MOD, CONFIG_APP_LOG_LEVEL);
 
 bool en_ble = true;
 static bool voltage_notify_enabled;
+static bool adv_running;
+static uint8_t power_mode_val;
+
+/* Connectable advertising; the interval follows the active power profile */
+static struct bt_le_adv_param adv_param;
 
 static void voltage_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
 {
@@ -76,6 +91,162 @@ static ssize_t read_sample_interval(struct bt_conn *conn, const struct bt_gatt_a
     return bt_gatt_attr_read(conn, attr, buf, len, offset, &sample_interval_ms, sizeof(sample_interval_ms));
 }
 
+#if IS_ENABLED(CONFIG_APP_BOOT_PROFILE)
+/* Boot stage timestamps in us since reset, one uint32 per enum boot_stage entry */
+static ssize_t read_boot_profile(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                 void *buf, uint16_t len, uint16_t offset)
+{
+    uint32_t stages[BOOT_STAGE_COUNT];
+
+    boot_prof_snapshot(stages);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, stages, sizeof(stages));
+}
+#endif
+
+static ssize_t read_power_mode(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                               void *buf, uint16_t len, uint16_t offset)
+{
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &power_mode_val, sizeof(power_mode_val));
+}
+
+#if IS_ENABLED(CONFIG_APP_ENERGY_ACCOUNTING)
+/* Estimated charge in nAh: total, adc, led, radio, cpu (uint32 each) */
+static ssize_t read_energy(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                           void *buf, uint16_t len, uint16_t offset)
+{
+    struct energy_report r;
+    uint32_t out[1 + ENERGY_SUB_COUNT];
+
+    energy_report_get(&r);
+    out[0] = r.total_nah;
+    for (int i = 0; i < ENERGY_SUB_COUNT; i++) {
+        out[1 + i] = r.charge_nah[i];
+    }
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, out, sizeof(out));
+}
+#endif
+
+#if IS_ENABLED(CONFIG_APP_TRANSIENT_CAPTURE)
+static bool transient_notify_enabled;
+
+static void transient_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    transient_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+    if (transient_notify_enabled) {
+        /* Deliver captures queued while nobody was listening */
+        transient_download_kick();
+    }
+}
+
+/* Read: 1 if capture mode is armed. Write 1 to arm, 0 to disarm. */
+static ssize_t read_transient_ctrl(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                   void *buf, uint16_t len, uint16_t offset)
+{
+    uint8_t armed = transient_is_armed();
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &armed, sizeof(armed));
+}
+
+static ssize_t write_transient_ctrl(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                    const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+    if (offset != 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+    if (len != 1) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+    transient_arm(((const uint8_t *)buf)[0] != 0);
+    return len;
+}
+#endif
+
+#if IS_ENABLED(CONFIG_APP_TIME_SYNC)
+static bool sample_ts_notify_enabled;
+
+static void sample_ts_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    sample_ts_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+}
+
+/* Read back the corrected clock and the sync quality */
+struct time_sync_status {
+    int64_t now_ms;             /* current absolute time, 0 if never synced */
+    int32_t drift_ppb;
+    uint32_t syncs;
+    int32_t last_error_us;
+} __packed;
+
+static ssize_t read_time_sync(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                              void *buf, uint16_t len, uint16_t offset)
+{
+    struct time_sync_stats st;
+    struct time_sync_status status;
+
+    time_sync_stats_get(&st);
+    status.now_ms = time_sync_abs_ms(time_sync_local_us());
+    status.drift_ppb = st.drift_ppb;
+    status.syncs = st.syncs;
+    status.last_error_us = st.last_error_us;
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &status, sizeof(status));
+}
+
+/* Write: reference time as int64 Unix ms, little-endian */
+static ssize_t write_time_sync(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                               const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+    if (offset != 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+    if (len != sizeof(int64_t)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+    if (time_sync_set((int64_t)sys_get_le64(buf))) {
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+    }
+    return len;
+}
+#endif
+
+/* Fault episodes then successful recoveries, one uint32 per enum recovery_subsys entry each */
+static ssize_t read_faults(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                           void *buf, uint16_t len, uint16_t offset)
+{
+    struct recovery_stats st;
+
+    recovery_stats_get(&st);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &st, sizeof(st));
+}
+
+/* Read/write the whole struct app_cfg; a valid write is applied and persisted */
+static ssize_t read_config(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                           void *buf, uint16_t len, uint16_t offset)
+{
+    struct app_cfg cfg;
+
+    app_config_get(&cfg);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &cfg, sizeof(cfg));
+}
+
+static ssize_t write_config(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                            const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+    struct app_cfg cfg;
+
+    if (offset != 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+    if (len != sizeof(cfg)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+    memcpy(&cfg, buf, sizeof(cfg));
+    if (app_config_set(&cfg)) {
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+    }
+    app_config_apply();
+    return len;
+}
+
 BT_GATT_SERVICE_DEFINE(custom_svc,
     BT_GATT_PRIMARY_SERVICE(BT_UUID_CUSTOM_SERVICE),
     BT_GATT_CHARACTERISTIC(BT_UUID_VOLTAGE_CHAR,
@@ -97,11 +268,122 @@ BT_GATT_SERVICE_DEFINE(custom_svc,
                            BT_GATT_PERM_READ,
                            read_service_name, NULL, NULL),
     BT_GATT_CUD("Service Name", BT_GATT_PERM_READ),
+#if IS_ENABLED(CONFIG_APP_BOOT_PROFILE)
+    BT_GATT_CHARACTERISTIC(BT_UUID_BOOT_PROFILE_CHAR,
+                           BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ,
+                           read_boot_profile, NULL, NULL),
+    BT_GATT_CUD("Boot stage times in us", BT_GATT_PERM_READ),
+#endif
+    /* 0 = normal, 1 = conserve, 2 = critical; notified on every transition */
+    BT_GATT_CHARACTERISTIC(BT_UUID_POWER_MODE_CHAR,
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_READ,
+                           read_power_mode, NULL, &power_mode_val),
+    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CUD("Power mode", BT_GATT_PERM_READ),
+    BT_GATT_CHARACTERISTIC(BT_UUID_FAULTS_CHAR,
+                           BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ,
+                           read_faults, NULL, NULL),
+    BT_GATT_CUD("Faults and recoveries: adc, ble, led, button", BT_GATT_PERM_READ),
+    /* interval ms (u32), threshold mV (u16), BLE enable (u8), notify every Nth sample (u8) */
+    BT_GATT_CHARACTERISTIC(BT_UUID_CONFIG_CHAR,
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+                           read_config, write_config, NULL),
+    BT_GATT_CUD("Configuration", BT_GATT_PERM_READ),
+#if IS_ENABLED(CONFIG_APP_ENERGY_ACCOUNTING)
+    BT_GATT_CHARACTERISTIC(BT_UUID_ENERGY_CHAR,
+                           BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ,
+                           read_energy, NULL, NULL),
+    BT_GATT_CUD("Charge in nAh: total, adc, led, radio, cpu", BT_GATT_PERM_READ),
+#endif
+#if IS_ENABLED(CONFIG_APP_TRANSIENT_CAPTURE)
+    BT_GATT_CHARACTERISTIC(BT_UUID_TRANSIENT_CTRL_CHAR,
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+                           read_transient_ctrl, write_transient_ctrl, NULL),
+    BT_GATT_CUD("Transient capture armed", BT_GATT_PERM_READ),
+    /* Notify-only: capture id (u16), offset (u16), then a slice of struct transient_capture */
+    BT_GATT_CHARACTERISTIC(BT_UUID_TRANSIENT_DATA_CHAR,
+                           BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_NONE,
+                           NULL, NULL, NULL),
+    BT_GATT_CCC(transient_ccc_cfg_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CUD("Transient capture data", BT_GATT_PERM_READ),
+#endif
+#if IS_ENABLED(CONFIG_APP_TIME_SYNC)
+    BT_GATT_CHARACTERISTIC(BT_UUID_TIME_SYNC_CHAR,
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+                           read_time_sync, write_time_sync, NULL),
+    BT_GATT_CUD("Reference time in Unix ms", BT_GATT_PERM_READ),
+    /* Notify-only: int64 Unix ms, uint16 mV, uint8 scan channel */
+    BT_GATT_CHARACTERISTIC(BT_UUID_SAMPLE_TS_CHAR,
+                           BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_NONE,
+                           NULL, NULL, NULL),
+    BT_GATT_CCC(sample_ts_ccc_cfg_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CUD("Timestamped samples", BT_GATT_PERM_READ),
+#endif
+);
+
+#if ADC_SCAN_NUM_CHANNELS > 1
+/* Latest value of every scan channel; entry 0 (battery) is served by custom_svc */
+static uint16_t channel_mv[ADC_SCAN_NUM_CHANNELS];
+
+static ssize_t read_channel(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                            void *buf, uint16_t len, uint16_t offset)
+{
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, attr->user_data, sizeof(uint16_t));
+}
+
+/* Characteristic value, CCC, CPF and CUD per secondary channel (attributes per channel below) */
+#define CHANNEL_ATTRS(node, prop, idx)                                              \
+    COND_CODE_0(idx, (), (                                                          \
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(BT_UUID_CHANNEL_CHAR_VAL(idx)),      \
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,                 \
+                           BT_GATT_PERM_READ,                                       \
+                           read_channel, NULL, &channel_mv[idx]),                   \
+    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),                      \
+    BT_GATT_CPF(&voltage_cpf),                                                      \
+    BT_GATT_CUD(ADC_SCAN_CHAN_NAME(idx), BT_GATT_PERM_READ),))
+#define CHANNEL_ATTR_COUNT 5
+/* Value attribute of channel idx: skip the service and the characteristic declaration */
+#define CHANNEL_VALUE_ATTR_IDX(idx) (1 + ((idx) - 1) * CHANNEL_ATTR_COUNT + 1)
+
+BT_GATT_SERVICE_DEFINE(channel_svc,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_CHANNEL_SERVICE),
+    DT_FOREACH_PROP_ELEM(ADC_SCAN_NODE, io_channels, CHANNEL_ATTRS)
 );
 
+void notify_channel(uint8_t idx, uint16_t mv)
+{
+    if (idx == 0 || idx >= ADC_SCAN_NUM_CHANNELS) {
+        return;
+    }
+    channel_mv[idx] = mv;
+    /* Only subscribed peers receive it; nothing to do when nobody is connected */
+    (void)bt_gatt_notify(NULL, &channel_svc.attrs[CHANNEL_VALUE_ATTR_IDX(idx)],
+                         &channel_mv[idx], sizeof(channel_mv[idx]));
+}
+#else
+void notify_channel(uint8_t idx, uint16_t mv)
+{
+    ARG_UNUSED(idx);
+    ARG_UNUSED(mv);
+}
+#endif /* ADC_SCAN_NUM_CHANNELS > 1 */
+
 static const struct bt_data ad[] = {
     BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
     BT_DATA(BT_DATA_NAME_COMPLETE, DEVICE_NAME, DEVICE_NAME_LEN),
+#if IS_ENABLED(CONFIG_BT_BAS)
+    /* Let standard Battery Service clients find us without a custom filter */
+    BT_DATA_BYTES(BT_DATA_UUID16_ALL, BT_UUID_16_ENCODE(BT_UUID_BAS_VAL)),
+#endif
 };
 
 /* Scan response: include the 128-bit service UUID and a small service-data payload with name */
@@ -123,14 +405,30 @@ static void connected(struct bt_conn *conn, uint8_t err)
         LOG_ERR("Connection failed, err 0x%02x %s", err, bt_hci_err_to_str(err));
         return;
     }
+    /* Connectable advertising stops once a connection is made */
+    adv_running = false;
+
+    struct bt_conn_info info;
+
+    if (bt_conn_get_info(conn, &info) == 0) {
+        energy_radio_set(ENERGY_RADIO_CONN, info.le.interval * 1250U);
+    }
     LOG_INF("Connected");
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
 {
+    energy_radio_set(ENERGY_RADIO_OFF, 0);
     LOG_INF("Disconnected, reason 0x%02x %s", reason, bt_hci_err_to_str(reason));
 }
 
+static void le_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+                             uint16_t timeout)
+{
+    /* With peripheral latency the radio may skip up to latency events */
+    energy_radio_set(ENERGY_RADIO_CONN, interval * 1250U * (latency + 1U));
+}
+
 static void recycled_cb(void)
 {
     LOG_INF("Connection object available from previous conn. Disconnect is complete!");
@@ -140,6 +438,7 @@ static void recycled_cb(void)
 BT_CONN_CB_DEFINE(conn_callbacks) = {
     .connected        = connected,
     .disconnected     = disconnected,
+    .le_param_updated = le_param_updated,
     .recycled         = recycled_cb,
 };
 
@@ -189,10 +488,12 @@ static void adv_work_handler(struct k_work *work)
 {
     if (!en_ble) {
         (void)bt_le_adv_stop();
+        adv_running = false;
+        energy_radio_set(ENERGY_RADIO_OFF, 0);
         LOG_INF("Advertising disabled by en_ble");
         return;
     }
-    int err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_2, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
+    int err = bt_le_adv_start(&adv_param, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
     if (err == -EALREADY) {
         LOG_DBG("Advertising already running");
         return;
@@ -202,14 +503,97 @@ static void adv_work_handler(struct k_work *work)
         LOG_ERR("Advertising failed to start (err %d)", err);
         return;
     }
+    adv_running = true;
+    /* Interval units are 0.625 ms; the controller picks a value in [min, max] */
+    energy_radio_set(ENERGY_RADIO_ADV, (adv_param.interval_min + adv_param.interval_max) * 625U / 2U);
+    boot_prof_mark(BOOT_STAGE_ADV_STARTED);
     LOG_INF("Advertising started");
 }
 
+static void adv_restart_work_handler(struct k_work *work)
+{
+    if (!adv_running) {
+        return; /* new interval applies at the next start */
+    }
+    (void)bt_le_adv_stop();
+    adv_running = false;
+    adv_work_handler(NULL);
+}
+
+static K_WORK_DEFINE(adv_restart_work, adv_restart_work_handler);
+
+void ble_set_adv_interval(uint16_t min, uint16_t max)
+{
+    if (adv_param.interval_min == min && adv_param.interval_max == max) {
+        return;
+    }
+    adv_param.interval_min = min;
+    adv_param.interval_max = max;
+    k_work_submit(&adv_restart_work);
+}
+
+#if IS_ENABLED(CONFIG_APP_TRANSIENT_CAPTURE)
+int notify_transient_chunk(const void *data, uint16_t len)
+{
+    const struct bt_gatt_attr *attr;
+
+    if (!transient_notify_enabled) {
+        return -ENOTCONN;
+    }
+    attr = bt_gatt_find_by_uuid(custom_svc.attrs, custom_svc.attr_count,
+                                BT_UUID_TRANSIENT_DATA_CHAR);
+    if (!attr) {
+        return -ENOENT;
+    }
+    return bt_gatt_notify(NULL, attr, data, len);
+}
+#endif
+
+#if IS_ENABLED(CONFIG_APP_TIME_SYNC)
+void notify_sample(uint8_t idx, uint16_t mv, int64_t abs_ms)
+{
+    struct __packed {
+        int64_t t_ms;
+        uint16_t mv;
+        uint8_t channel;
+    } pkt = { .t_ms = abs_ms, .mv = mv, .channel = idx };
+    const struct bt_gatt_attr *attr;
+
+    if (!sample_ts_notify_enabled) {
+        return;
+    }
+    attr = bt_gatt_find_by_uuid(custom_svc.attrs, custom_svc.attr_count, BT_UUID_SAMPLE_TS_CHAR);
+    if (attr) {
+        (void)bt_gatt_notify(NULL, attr, &pkt, sizeof(pkt));
+    }
+}
+#else
+void notify_sample(uint8_t idx, uint16_t mv, int64_t abs_ms)
+{
+    ARG_UNUSED(idx);
+    ARG_UNUSED(mv);
+    ARG_UNUSED(abs_ms);
+}
+#endif
+
+void notify_power_mode(uint8_t mode)
+{
+    const struct bt_gatt_attr *attr;
+
+    power_mode_val = mode;
+    attr = bt_gatt_find_by_uuid(custom_svc.attrs, custom_svc.attr_count, BT_UUID_POWER_MODE_CHAR);
+    if (attr) {
+        /* Only subscribed peers receive it */
+        (void)bt_gatt_notify(NULL, attr, &power_mode_val, sizeof(power_mode_val));
+    }
+}
+
 void ble_advertising_start(void)
 {
     k_work_submit(&adv_work);
 }
 
+
 void notify_voltage(uint16_t mv)
 {
     voltage_mv = mv;
@@ -219,34 +603,113 @@ void notify_voltage(uint16_t mv)
     (void)bt_gatt_notify(NULL, &custom_svc.attrs[VOLTAGE_ATTR_IDX], &voltage_mv, sizeof(voltage_mv));
 }
 
-int ble_init(void)
-{
-    en_ble = DT_NODE_HAS_PROP(APP_NODE, enable_ble);// get the devicetree value
-    en_ble = IS_ENABLED(CONFIG_APP_ENABLE_BLE);// get the Kconfig value. This is the final value to use
-    // Initialize the Bluetooth Subsystem when enabled by DT
+static ble_ready_cb_t ble_ready_cb;
+
 #if ENABLE_BLE
-    int err = bt_enable(NULL);
+/* Set when bt_enable() or its completion failed; the stack must be torn down to retry */
+static bool bt_init_failed;
+
+static void bt_ready(int err)
+{
     if (err) {
-        app_evt_raise(APP_ERR_BLE);
         LOG_ERR("Bluetooth init failed (err %d)", err);
-        return err;
+        goto out;
     }
+    boot_prof_mark(BOOT_STAGE_BT_READY);
+
     /* Set device name from Kconfig option (non-persistent) */
     (void)bt_set_name(DEVICE_NAME);
 #if defined(CONFIG_APP_BLE_SECURITY_ENABLED)
     err = bt_conn_auth_cb_register(&conn_auth_callbacks);
     if (err) {
-        LOG_ERR("Failed to register authorization callbacks");
-        return err;
+        LOG_ERR("Failed to register authorization callbacks (err %d)", err);
+        goto out;
     }
     err = bt_conn_auth_info_cb_register(&conn_auth_info_callbacks);
     if (err) {
-        LOG_ERR("Failed to register authorization info callbacks");
-        return err;
+        LOG_ERR("Failed to register authorization info callbacks (err %d)", err);
+        goto out;
     }
 #endif
-    k_work_init(&adv_work, adv_work_handler);
     LOG_INF("Bluetooth initialized");
+out:
+    /* Security must not end up silently off: every failure above is a BLE fault */
+    bt_init_failed = err != 0;
+    if (err) {
+        app_evt_raise(APP_ERR_BLE);
+    }
+    /* Completes a recovery that re-ran bt_enable(); ignored at boot */
+    recovery_done(RECOVERY_BLE, err);
+    if (ble_ready_cb) {
+        ble_ready_cb(err);
+    }
+}
+#endif /* ENABLE_BLE */
+
+int ble_recover(void)
+{
+#if ENABLE_BLE
+    if (bt_init_failed) {
+        /* A failed init leaves the stack marked enabled, so bt_enable() alone would only
+         * return -EALREADY. Completes in bt_ready(), which hands over to ble_ready_cb again.
+         */
+        bt_init_failed = false;
+        (void)bt_disable();
+        int err = bt_enable(bt_ready);
+
+        if (err) {
+            bt_init_failed = true;
+            return err;
+        }
+        return RECOVERY_IN_PROGRESS;
+    }
+    if (!bt_is_ready()) {
+        /* The first init is still running; it reports through bt_ready() as well */
+        return RECOVERY_IN_PROGRESS;
+    }
+    /* Stack is up: restart advertising from scratch */
+    (void)bt_le_adv_stop();
+    adv_running = false;
+    ble_advertising_start();
+#endif
+    return 0;
+}
+
+int ble_init(ble_ready_cb_t ready_cb)
+{
+    struct app_cfg cfg;
+
+    app_config_get(&cfg);
+    en_ble = cfg.en_ble;// DT value, overridden by Kconfig, overridden by the stored config
+    ble_ready_cb = ready_cb;
+    /* Start from the fast connectable defaults; power profiles only change the interval,
+     * which may already have been set by a profile applied before BLE init.
+     */
+    struct bt_le_adv_param defaults = *BT_LE_ADV_CONN_FAST_2;
+
+    if (adv_param.interval_min != 0) {
+        defaults.interval_min = adv_param.interval_min;
+        defaults.interval_max = adv_param.interval_max;
+    }
+    adv_param = defaults;
+    k_work_init(&adv_work, adv_work_handler);
+    // Initialize the Bluetooth Subsystem when enabled by DT.
+    // bt_enable() returns immediately and completes in bt_ready().
+#if ENABLE_BLE
+    int err = bt_enable(bt_ready);
+    if (err) {
+        bt_init_failed = true;
+        app_evt_raise(APP_ERR_BLE);
+        LOG_ERR("Bluetooth init failed (err %d)", err);
+        if (ready_cb) {
+            ready_cb(err);
+        }
+        return err;
+    }
+#else
+    if (ready_cb) {
+        ready_cb(-ENOTSUP);
+    }
 #endif
     return 0;
 }
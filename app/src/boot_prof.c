@@ -0,0 +1,66 @@
+/* Boot-stage timestamp recorder */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+#include "boot_prof.h"
+
+LOG_MODULE_REGISTER(BOOT_PROF, CONFIG_APP_LOG_LEVEL);
+
+static const char *const stage_names[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_MAIN]            = "main",
+    [BOOT_STAGE_ADC_READY]       = "adc_ready",
+    [BOOT_STAGE_FIRST_SAMPLE]    = "first_sample",
+    [BOOT_STAGE_LED_READY]       = "led_ready",
+    [BOOT_STAGE_BUTTON_READY]    = "button_ready",
+    [BOOT_STAGE_WDT_READY]       = "wdt_ready",
+    [BOOT_STAGE_BT_READY]        = "bt_ready",
+    [BOOT_STAGE_SETTINGS_LOADED] = "settings_loaded",
+    [BOOT_STAGE_ADV_STARTED]     = "adv_started",
+    [BOOT_STAGE_CONFIG_LOADED]   = "config_loaded",
+};
+
+/* Microseconds since kernel start per stage; 0 means "not reached" (stored as us + 1) */
+static atomic_t stage_us[BOOT_STAGE_COUNT];
+
+void boot_prof_mark(enum boot_stage stage)
+{
+    if (stage >= BOOT_STAGE_COUNT) {
+        return;
+    }
+    /* +1 so that a stage reached at t=0 is distinguishable from "not reached" */
+    atomic_val_t us = (atomic_val_t)k_cyc_to_us_floor32(k_cycle_get_32()) + 1;
+
+    /* Keep only the first occurrence */
+    (void)atomic_cas(&stage_us[stage], 0, us);
+}
+
+uint32_t boot_prof_get_us(enum boot_stage stage)
+{
+    if (stage >= BOOT_STAGE_COUNT) {
+        return UINT32_MAX;
+    }
+    atomic_val_t v = atomic_get(&stage_us[stage]);
+
+    return v ? (uint32_t)(v - 1) : UINT32_MAX;
+}
+
+void boot_prof_snapshot(uint32_t out[BOOT_STAGE_COUNT])
+{
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        out[i] = boot_prof_get_us(i);
+    }
+}
+
+void boot_prof_dump(void)
+{
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        uint32_t us = boot_prof_get_us(i);
+
+        if (us == UINT32_MAX) {
+            LOG_INF("boot: %-16s --", stage_names[i]);
+        } else {
+            LOG_INF("boot: %-16s %u us", stage_names[i], us);
+        }
+    }
+}
@@ -1,123 +1,314 @@
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/reboot.h>
 #include "app.h"
 #include <zephyr/logging/log.h>
 #include "app_events.h"
+#include "app_config.h"
+#include "boot_prof.h"
+#include "buttons.h"
+#if IS_ENABLED(CONFIG_APP_TRANSIENT_CAPTURE)
+#include "transient.h"
+#endif
 
 LOG_MODULE_REGISTER(BUTTONS, CONFIG_APP_LOG_LEVEL);
 
-#define MIN_BUTTON_DEBOUNCE_TIME_MS CONFIG_APP_BUTTON_DEBOUNCE_DELAY_MS
-#define TIME_TO_TRIGGGER_ERROR_STATE_MS 2000
-
-struct k_work_delayable button0_reset_work;
+#define DEBOUNCE_MS CONFIG_APP_BUTTON_DEBOUNCE_DELAY_MS
 
-static bool button0_is_pressed = true;
-
-#if DT_NODE_EXISTS(DT_ALIAS(btn-user))
-#define BUTTON0 DT_ALIAS(btn-user)
+#if DT_NODE_EXISTS(DT_ALIAS(btn_user))
+#define BUTTON0 DT_ALIAS(btn_user)
 #elif DT_NODE_EXISTS(DT_ALIAS(button0))
 #define BUTTON0 DT_ALIAS(button0)
-#elif DT_NODE_EXISTS(DT_NODELABEL(btn-user))
-#define BUTTON0 DT_NODELABEL(btn-user)
+#elif DT_NODE_EXISTS(DT_NODELABEL(btn_user))
+#define BUTTON0 DT_NODELABEL(btn_user)
 #elif DT_NODE_EXISTS(DT_NODELABEL(button0))
 #define BUTTON0 DT_NODELABEL(button0)
 #else
 #define BUTTON0 DT_INVALID_NODE
 #endif
 
+static const char *const gesture_names[BUTTON_GESTURE_COUNT] = {
+    [BUTTON_GESTURE_SHORT]  = "short",
+    [BUTTON_GESTURE_LONG]   = "long",
+    [BUTTON_GESTURE_DOUBLE] = "double",
+    [BUTTON_GESTURE_HOLD]   = "hold",
+};
+
+static enum button_action actions[BUTTON_GESTURE_COUNT] = {
+    [BUTTON_GESTURE_SHORT]  = CONFIG_APP_BUTTON_ACTION_SHORT,
+    [BUTTON_GESTURE_LONG]   = CONFIG_APP_BUTTON_ACTION_LONG,
+    [BUTTON_GESTURE_DOUBLE] = CONFIG_APP_BUTTON_ACTION_DOUBLE,
+    [BUTTON_GESTURE_HOLD]   = CONFIG_APP_BUTTON_ACTION_HOLD,
+};
+
+void button_set_action(enum button_gesture gesture, enum button_action action)
+{
+    if (gesture < BUTTON_GESTURE_COUNT && action < BUTTON_ACTION_COUNT) {
+        actions[gesture] = action;
+    }
+}
+
+/*
+ * Edge queue: single producer (GPIO ISR), single consumer (button thread).
+ * Each slot holds the cycle counter at the edge. The indices only ever grow;
+ * a full queue drops the edge, which the level sampling makes harmless.
+ */
+#define EDGE_QUEUE_LEN 16
+BUILD_ASSERT(IS_POWER_OF_TWO(EDGE_QUEUE_LEN));
+
+static uint32_t edge_cyc[EDGE_QUEUE_LEN];
+static atomic_t edge_head;      /* written by the ISR */
+static atomic_t edge_tail;      /* written by the thread */
+static atomic_t edges_dropped;
+static K_SEM_DEFINE(edge_sem, 0, 1);
+
 #if DT_NODE_EXISTS(BUTTON0)
 #define BUTTON0_DEV DT_PHANDLE(BUTTON0, gpios)
 #define BUTTON0_PIN DT_PHA(BUTTON0, gpios, pin)
 #define BUTTON0_FLAGS DT_PHA(BUTTON0, gpios, flags)
 
 static const struct device *button0_dev = DEVICE_DT_GET(BUTTON0_DEV);
-// static void adv_update_work_handler(struct k_work *work)
-// {
-// 	advertising_update();
-// }
-// static K_WORK_DEFINE(adv_update_work, adv_update_work_handler);
 
+// Interrupt on both edges: only record when it happened and wake the thread
 static void button0_cb(const struct device *port, struct gpio_callback *cb,
                        gpio_port_pins_t pins)
 {
-    static uint32_t prev_pres = 0;
-	//static bool is_pressed = true;
-	uint32_t elapsed_time = 0;
-
-    // Button is configured to interrupt on both edges, so this callback will be called
-    // twice for each press. We determine whether it was a press or release by tracking
-	if(button0_is_pressed)
-	{
-	// Button was pressed down now register the time and set the flag
-		button0_is_pressed = false;
-		prev_pres = k_uptime_get_32();// get uptime in milliseconds
-
-		//Just in case the either press or release event is missed or not registered
-		//This will reset the button state after 4 seconds
-		k_work_reschedule(&button0_reset_work, K_SECONDS(4));
-	}
-	else{
-        // Button was released now calculate the elapsed time and if it is more than debounce time
-        // consider it as a valid press
-		button0_is_pressed = true;
-
-		elapsed_time = k_uptime_get_32() - prev_pres;
-
-		if(elapsed_time > TIME_TO_TRIGGGER_ERROR_STATE_MS) //use for demoing error state led pattern. This has no functional purpose
-		{
-			app_evt_raise(APP_ERR_BUTTON);
-		}
-		else if(elapsed_time > MIN_BUTTON_DEBOUNCE_TIME_MS) //debouncing
-		{
-			// toggle the ble enable/disable flag
-			en_ble = !en_ble;
-			LOG_INF("Advertising toggle button: %s\n", en_ble?"ENABLED":"DISABLED");
-
-			// only if sampling work is battery sample task is not running
-			// Restart sampling work immediately
-			if(k_work_delayable_busy_get(&battery_voltage_work) == 0) 
-			{
-				k_work_reschedule(&battery_voltage_work, K_NO_WAIT);
-			}
-        }
-		else{}
-	}
+    atomic_val_t head = atomic_get(&edge_head);
+
+    if (head - atomic_get(&edge_tail) >= EDGE_QUEUE_LEN) {
+        atomic_inc(&edges_dropped);
+    } else {
+        edge_cyc[head & (EDGE_QUEUE_LEN - 1)] = k_cycle_get_32();
+        atomic_set(&edge_head, head + 1);
+    }
+    k_sem_give(&edge_sem);
+}
+
+static bool button0_pressed(void)
+{
+    // Logical level: GPIO_ACTIVE_LOW from devicetree is already applied
+    return gpio_pin_get(button0_dev, BUTTON0_PIN) > 0;
+}
+#else
+static bool button0_pressed(void)
+{
+    return false;
 }
 #endif /* BUTTON0 */
 
-static void button0_reset(struct k_work *work)
+static void toggle_ble(void)
 {
-	button0_is_pressed = true;
-	//printk("new threshold value is... %d\n",threshold_do_f16 );
+    // Toggle the stored flag in one step, so a concurrent config write is not lost;
+    // the flash write is deferred to the workqueue
+    en_ble = app_config_toggle_en_ble();
+    LOG_INF("Advertising toggle button: %s", en_ble ? "ENABLED" : "DISABLED");
+
+    // Restart sampling immediately if the battery sample task is not running
+    if (en_ble && !timer_svc_is_active(&battery_task)) {
+        adc_sampling_restart();
+    }
 }
 
-int button_init()
+static void run_action(enum button_gesture gesture)
 {
-	int err;
-#if DT_NODE_EXISTS(BUTTON0)
+    enum button_action action = actions[gesture];
+
+    LOG_INF("button: %s press", gesture_names[gesture]);
+
+    switch (action) {
+    case BUTTON_ACTION_TOGGLE_BLE:
+        toggle_ble();
+        break;
+    case BUTTON_ACTION_DEMO_ERROR:
+        //use for demoing error state led pattern. This has no functional purpose
+        app_evt_raise(APP_ERR_BUTTON);
+        break;
+    case BUTTON_ACTION_TOGGLE_CAPTURE:
+#if IS_ENABLED(CONFIG_APP_TRANSIENT_CAPTURE)
+        transient_arm(!transient_is_armed());
+#endif
+        break;
+    case BUTTON_ACTION_REBOOT:
+        LOG_PANIC();
+        sys_reboot(SYS_REBOOT_COLD);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Gesture classifier state; all times are uptime in ms */
+static bool pressed;
+static uint32_t press_ms;
+static bool hold_fired;
+static bool short_pending;      /* a short press waits for a possible second one */
+static uint32_t short_deadline_ms;
+static bool second_press;
+
+static void on_press(uint32_t t)
+{
+    press_ms = t;
+    hold_fired = false;
+    second_press = short_pending;
+}
+
+static void on_release(uint32_t t)
+{
+    uint32_t dur = t - press_ms;
+
+    if (hold_fired) {
+        return;
+    }
+    if (dur >= CONFIG_APP_BUTTON_LONG_MS) {
+        if (short_pending) {
+            short_pending = false;
+            run_action(BUTTON_GESTURE_SHORT);
+        }
+        run_action(BUTTON_GESTURE_LONG);
+        return;
+    }
+    if (second_press) {
+        short_pending = false;
+        run_action(BUTTON_GESTURE_DOUBLE);
+        return;
+    }
+    if (actions[BUTTON_GESTURE_DOUBLE] == BUTTON_ACTION_NONE) {
+        // Nothing to disambiguate from; act without the double-click delay
+        run_action(BUTTON_GESTURE_SHORT);
+        return;
+    }
+    short_pending = true;
+    short_deadline_ms = t + CONFIG_APP_BUTTON_DOUBLE_MS;
+}
+
+/* Fire time-based gestures that are due; returns ms until the next one (or -1) */
+static int32_t run_timers(uint32_t now)
+{
+    int32_t next = -1;
+
+    // Without a hold action a long press stays a long press, whatever its length
+    if (pressed && !hold_fired && actions[BUTTON_GESTURE_HOLD] != BUTTON_ACTION_NONE) {
+        int32_t left = (int32_t)(press_ms + CONFIG_APP_BUTTON_HOLD_MS - now);
+
+        if (left <= 0) {
+            hold_fired = true;
+            if (short_pending) {
+                short_pending = false;
+                run_action(BUTTON_GESTURE_SHORT);
+            }
+            run_action(BUTTON_GESTURE_HOLD);
+        } else {
+            next = left;
+        }
+    }
+    if (short_pending && !pressed) {
+        int32_t left = (int32_t)(short_deadline_ms - now);
+
+        if (left <= 0) {
+            short_pending = false;
+            run_action(BUTTON_GESTURE_SHORT);
+        } else if (next < 0 || left < next) {
+            next = left;
+        }
+    }
+    return next;
+}
+
+static void button_thread(void *p1, void *p2, void *p3)
+{
+    bool settling = false;
+    uint32_t first_edge_ms = 0;     /* start of the current bounce burst */
+    uint32_t last_edge_ms = 0;
+
+    for (;;) {
+        uint32_t now = k_uptime_get_32();
+        int32_t wait = run_timers(now);
+
+        if (settling) {
+            int32_t left = (int32_t)(last_edge_ms + DEBOUNCE_MS - now);
+
+            wait = (wait < 0 || left < wait) ? MAX(left, 0) : wait;
+        }
+        (void)k_sem_take(&edge_sem, wait < 0 ? K_FOREVER : K_MSEC(wait));
+
+        // Drain the edge queue; only the first and last edge of a burst matter
+        now = k_uptime_get_32();
+        uint32_t now_cyc = k_cycle_get_32();
+        atomic_val_t tail = atomic_get(&edge_tail);
 
-	err = gpio_pin_configure(button0_dev, BUTTON0_PIN,
-				 BUTTON0_FLAGS | GPIO_INPUT);
-	if (err) {
-		return err;
-	}
+        while (tail != atomic_get(&edge_head)) {
+            uint32_t cyc = edge_cyc[tail & (EDGE_QUEUE_LEN - 1)];
+            uint32_t t = now - k_cyc_to_ms_floor32(now_cyc - cyc);
 
-	static struct gpio_callback gpio_cb0;
+            if (!settling) {
+                settling = true;
+                first_edge_ms = t;
+            }
+            last_edge_ms = t;
+            tail++;
+            atomic_set(&edge_tail, tail);
+        }
+        if (atomic_get(&edges_dropped)) {
+            LOG_DBG("%ld button edges dropped", atomic_clear(&edges_dropped));
+        }
+
+        // Debounce: once the edges have been quiet long enough, the pin level is the truth
+        if (!settling || (int32_t)(now - last_edge_ms) < DEBOUNCE_MS) {
+            continue;
+        }
+        settling = false;
+
+        bool level = button0_pressed();
+
+        if (level == pressed) {
+            continue; // a bounce or glitch that came back to where it was
+        }
+        pressed = level;
+        if (pressed) {
+            on_press(first_edge_ms);
+        } else {
+            on_release(first_edge_ms);
+        }
+    }
+}
+
+K_THREAD_DEFINE(button_tid, CONFIG_APP_BUTTON_STACK_SIZE, button_thread, NULL, NULL, NULL,
+                CONFIG_APP_BUTTON_THREAD_PRIO, 0, 0);
+
+// Also the recovery hook for APP_ERR_BUTTON, so it must be safe to call again
+int button_init(void)
+{
+#if DT_NODE_EXISTS(BUTTON0)
+    static struct gpio_callback gpio_cb0;
+    static bool cb_added;
+    int err;
+
+    err = gpio_pin_configure(button0_dev, BUTTON0_PIN, BUTTON0_FLAGS | GPIO_INPUT);
+    if (err) {
+        return err;
+    }
 
-	err = gpio_pin_interrupt_configure(button0_dev, BUTTON0_PIN,
-					   GPIO_INT_EDGE_BOTH);
-	if (err) {
-		return err;
-	}
+    if (!cb_added) {
+        gpio_init_callback(&gpio_cb0, button0_cb, BIT(BUTTON0_PIN));
+        err = gpio_add_callback(button0_dev, &gpio_cb0);
+        if (err) {
+            return err;
+        }
+        cb_added = true;
+    }
 
-	gpio_init_callback(&gpio_cb0, button0_cb, BIT(BUTTON0_PIN));
-	gpio_add_callback(button0_dev, &gpio_cb0);
+    // Interrupts last, so no edge arrives before the callback is in place
+    err = gpio_pin_interrupt_configure(button0_dev, BUTTON0_PIN, GPIO_INT_EDGE_BOTH);
+    if (err) {
+        return err;
+    }
 
 #else
-	LOG_ERR("WARNING: Buttons not supported on this board.\n");
+    LOG_ERR("WARNING: Buttons not supported on this board.\n");
 #endif
 
-    k_work_init_delayable(&button0_reset_work, button0_reset);
+    boot_prof_mark(BOOT_STAGE_BUTTON_READY);
 
-	return 0;
-}
\ No newline at end of file
+    return 0;
+}
@@ -0,0 +1,171 @@
+/* Energy accounting: on-time per subsystem, radio events and CPU runtime turned into charge */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+#include "energy.h"
+
+LOG_MODULE_REGISTER(ENERGY, CONFIG_APP_LOG_LEVEL);
+
+/* Average current while a switched subsystem is on, from the Kconfig table */
+static const uint32_t active_ua[ENERGY_SUB_COUNT] = {
+    [ENERGY_ADC] = CONFIG_APP_ENERGY_ADC_UA,
+    [ENERGY_LED] = CONFIG_APP_ENERGY_LED_UA,
+};
+
+struct sub_state {
+    bool on;
+    int64_t since_ticks;
+    uint64_t active_ticks;
+};
+
+static struct sub_state subs[ENERGY_SUB_COUNT];
+static struct k_spinlock lock;
+
+/* Radio: time spent per state and the number of radio events it implies */
+static enum energy_radio_state radio_state;
+static uint32_t radio_interval_us;
+static uint64_t adv_events;
+static uint64_t conn_events;
+
+/* Close the open segment of sub up to now; must be called with lock held */
+static uint64_t close_segment_locked(struct sub_state *s, int64_t now)
+{
+    uint64_t elapsed = 0;
+
+    if (s->on) {
+        elapsed = now - s->since_ticks;
+        s->active_ticks += elapsed;
+        s->since_ticks = now;
+    }
+    return elapsed;
+}
+
+static void account_radio_locked(int64_t now)
+{
+    uint64_t elapsed = close_segment_locked(&subs[ENERGY_RADIO], now);
+
+    if (radio_interval_us == 0) {
+        return;
+    }
+    uint64_t events = k_ticks_to_us_floor64(elapsed) / radio_interval_us;
+
+    if (radio_state == ENERGY_RADIO_ADV) {
+        adv_events += events;
+    } else if (radio_state == ENERGY_RADIO_CONN) {
+        conn_events += events;
+    }
+}
+
+void energy_set(enum energy_sub sub, bool on)
+{
+    if (sub >= ENERGY_SUB_COUNT || sub == ENERGY_RADIO || sub == ENERGY_CPU) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct sub_state *s = &subs[sub];
+    int64_t now = k_uptime_ticks();
+
+    if (s->on != on) {
+        close_segment_locked(s, now);
+        s->on = on;
+        s->since_ticks = now;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+void energy_radio_set(enum energy_radio_state state, uint32_t interval_us)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int64_t now = k_uptime_ticks();
+
+    account_radio_locked(now);
+    radio_state = state;
+    radio_interval_us = interval_us;
+    subs[ENERGY_RADIO].on = (state != ENERGY_RADIO_OFF);
+    subs[ENERGY_RADIO].since_ticks = now;
+    k_spin_unlock(&lock, key);
+}
+
+/* uA * ms -> nAh */
+static uint32_t ua_ms_to_nah(uint64_t ua, uint64_t ms)
+{
+    return (uint32_t)((ua * ms) / 3600U);
+}
+
+void energy_report_get(struct energy_report *r)
+{
+    k_thread_runtime_stats_t cpu;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int64_t now = k_uptime_ticks();
+
+    account_radio_locked(now);
+    for (int i = 0; i < ENERGY_SUB_COUNT; i++) {
+        if (i != ENERGY_RADIO) {
+            close_segment_locked(&subs[i], now);
+        }
+        r->active_ms[i] = k_ticks_to_ms_floor64(subs[i].active_ticks);
+        r->charge_nah[i] = ua_ms_to_nah(active_ua[i], r->active_ms[i]);
+    }
+    r->radio_events = (uint32_t)(adv_events + conn_events);
+    /* nC per event -> nAh */
+    r->charge_nah[ENERGY_RADIO] = (uint32_t)((adv_events * CONFIG_APP_ENERGY_ADV_EVENT_NC +
+                                              conn_events * CONFIG_APP_ENERGY_CONN_EVENT_NC) / 3600U);
+    k_spin_unlock(&lock, key);
+
+    /* CPU: non-idle execution vs idle time from the scheduler's runtime statistics */
+    if (k_thread_runtime_stats_all_get(&cpu) == 0) {
+        uint64_t busy_ms = k_cyc_to_ms_floor64(cpu.total_cycles);
+
+        r->cpu_idle_ms = k_cyc_to_ms_floor64(cpu.idle_cycles);
+        r->active_ms[ENERGY_CPU] = busy_ms;
+        r->charge_nah[ENERGY_CPU] = ua_ms_to_nah(CONFIG_APP_ENERGY_CPU_ACTIVE_UA, busy_ms) +
+                                    ua_ms_to_nah(CONFIG_APP_ENERGY_CPU_IDLE_UA, r->cpu_idle_ms);
+    }
+
+    r->total_nah = 0;
+    for (int i = 0; i < ENERGY_SUB_COUNT; i++) {
+        r->total_nah += r->charge_nah[i];
+    }
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static const char *const sub_names[ENERGY_SUB_COUNT] = {
+    [ENERGY_ADC]   = "adc",
+    [ENERGY_LED]   = "led",
+    [ENERGY_RADIO] = "radio",
+    [ENERGY_CPU]   = "cpu",
+};
+
+static void thread_stats_cb(const struct k_thread *thread, void *user_data)
+{
+    const struct shell *sh = user_data;
+    k_thread_runtime_stats_t st;
+    const char *name = k_thread_name_get((k_tid_t)thread);
+
+    if (k_thread_runtime_stats_get((k_tid_t)thread, &st) == 0) {
+        shell_print(sh, "  %-20s %10llu ms", name ? name : "?",
+                    k_cyc_to_ms_floor64(st.execution_cycles));
+    }
+}
+
+static int cmd_energy(const struct shell *sh, size_t argc, char **argv)
+{
+    struct energy_report r;
+
+    energy_report_get(&r);
+    for (int i = 0; i < ENERGY_SUB_COUNT; i++) {
+        shell_print(sh, "%-6s %10llu ms %7u.%03u uAh", sub_names[i], r.active_ms[i],
+                    r.charge_nah[i] / 1000, r.charge_nah[i] % 1000);
+    }
+    shell_print(sh, "radio events %u, cpu idle %llu ms", r.radio_events, r.cpu_idle_ms);
+    shell_print(sh, "total  %u.%03u uAh", r.total_nah / 1000, r.total_nah % 1000);
+    shell_print(sh, "threads:");
+    k_thread_foreach(thread_stats_cb, (void *)sh);
+    return 0;
+}
+
+SHELL_CMD_REGISTER(energy, NULL, "Show estimated charge per subsystem and thread", cmd_energy);
+#endif /* CONFIG_SHELL */
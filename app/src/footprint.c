@@ -0,0 +1,42 @@
+/* Thread stack high-water report (thread analyzer) */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/debug/thread_analyzer.h>
+#include <zephyr/logging/log.h>
+#include "footprint.h"
+#include "timer_svc.h"
+
+LOG_MODULE_REGISTER(FOOTPRINT, CONFIG_APP_LOG_LEVEL);
+
+static void stack_cb(struct thread_analyzer_info *info)
+{
+    /* printk rather than LOG: the lines are parsed and must not be dropped or reordered */
+    printk("STACK %s %zu %zu\n", info->name, info->stack_size, info->stack_used);
+}
+
+void footprint_stack_report(void)
+{
+    /* Peaks only grow, so the last report of a run is the one that counts */
+    printk("STACK-REPORT %lld\n", k_uptime_get());
+    thread_analyzer_run(stack_cb, 0);
+}
+
+#if CONFIG_APP_STACK_REPORT_INTERVAL_S > 0
+static void report_fn(struct timer_svc_task *task)
+{
+    footprint_stack_report();
+}
+
+static TIMER_SVC_TASK_DEFINE(report_task, report_fn);
+
+static int footprint_init(void)
+{
+    uint32_t period = CONFIG_APP_STACK_REPORT_INTERVAL_S * 1000U;
+
+    timer_svc_start(&report_task, period, period / 2, period);
+    return 0;
+}
+
+SYS_INIT(footprint_init, APPLICATION, 0);
+#endif
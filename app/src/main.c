@@ -18,6 +18,8 @@
 #include "app_events.h"
 #include "app_config.h"
 #include "ble.h"
+#include "boot_prof.h"
+#include "power_mode.h"
 
 #include <zephyr/logging/log.h>
 
@@ -27,6 +29,8 @@ LOG_MODULE_REGISTER(APP, CONFIG_APP_LOG_LEVEL);
 static uint32_t sample_count;// count of successful battery voltage samples taken
 /* settings key for persistent sample count */
 static const char *const SAMPLE_COUNT_KEY = "app/sample_count"; /* settings key for persistent sample count */
+/* Set once settings_load() has run; saves before that would race the load */
+static bool settings_ready;
 
 /* BLE GATT and advertising are handled in ble.c */
 
@@ -35,12 +39,16 @@ static const char *const SAMPLE_COUNT_KEY = "app/sample_count"; /* settings key
 static int settings_set_handler(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg)
 {
 	if (strcmp(key, "sample_count") == 0) {
-		if (len != sizeof(sample_count)) {
+		uint32_t stored;
+
+		if (len != sizeof(stored)) {
 			LOG_WRN("settings: unexpected size %zu for %s", len, key);
 			return -EINVAL;
 		}
-		int rc = read_cb(cb_arg, &sample_count, sizeof(sample_count));
+		int rc = read_cb(cb_arg, &stored, sizeof(stored));
 		if (rc >= 0) {
+			/* Samples may already have been taken before settings were loaded; keep them */
+			sample_count += stored;
 			LOG_INF("settings: loaded %s=%u", SAMPLE_COUNT_KEY, sample_count);
 			return 0;
 		}
@@ -57,7 +65,7 @@ SETTINGS_STATIC_HANDLER_DEFINE(app, "app", NULL, settings_set_handler, NULL, NUL
 void sample_count_increment_and_save(void)
 {
 	sample_count++;
-	if (IS_ENABLED(CONFIG_SETTINGS)) {
+	if (IS_ENABLED(CONFIG_SETTINGS) && settings_ready) {
 		int rc = settings_save_one(SAMPLE_COUNT_KEY, &sample_count, sizeof(sample_count));
 		if (rc) {
 			LOG_ERR("settings: save %s failed (%d)", SAMPLE_COUNT_KEY, rc);
@@ -67,20 +75,78 @@ void sample_count_increment_and_save(void)
 	}
 }
 
+/* Called once the BLE stack is up (from the bt_enable() callback), or right away
+ * when BLE is not built in. Settings are loaded here rather than in main() because
+ * the BT settings backend is only initialized by bt_enable(), and the full NVS scan
+ * must not delay the first sample.
+ */
+static void ble_ready(int err)
+{
+	/* A BLE recovery re-runs bt_enable() and comes back here; load only once */
+	if (IS_ENABLED(CONFIG_SETTINGS) && !settings_ready) {
+		int rc = settings_load();
+		if (rc) {
+			LOG_ERR("settings: load failed (%d)", rc);
+		}
+		settings_ready = true;
+		boot_prof_mark(BOOT_STAGE_SETTINGS_LOADED);
+	}
+
+	// Start BLE advertising if enabled and not already started
+	if (!err) {
+		ble_advertising_start();
+	}
+
+	/* Also when BLE failed: the stages reached so far are what explains the failure */
+	boot_prof_dump();
+}
+
+/* Apply a changed configuration record at runtime (e.g. written over BLE) */
+void app_config_apply(void)
+{
+	struct app_cfg cfg;
+
+	app_config_get(&cfg);
+	adc_set_threshold(cfg.threshold_mv);
+	power_mode_init(cfg.sample_interval_ms, cfg.notify_every);
+	if (en_ble != (bool)cfg.en_ble) {
+		en_ble = cfg.en_ble;
+		// Advertising follows en_ble; sampling restarts like on a button toggle
+		ble_advertising_start();
+		if (en_ble && !timer_svc_is_active(&battery_task)) {
+			adc_sampling_restart();
+		}
+	}
+}
 
 int main(void)
 {
 	int err;
 
+	boot_prof_mark(BOOT_STAGE_MAIN);
 	LOG_INF("Starting FW-CHALLENGE\n");
 
-	// Initialize the LED first so that we can use it to indicate failures
-	// in other subsystems
+	// One direct read of the configuration record; everything below uses it
+	err = app_config_init();
+	if (err) {
+		LOG_WRN("Config storage unavailable (%d), using defaults", err);
+	}
+
+	// Initialize the ADC first so the first sample is taken right away. The sample
+	// work runs on the cooperative system workqueue and preempts main() as soon as
+	// it is queued; everything below comes up around it.
+	err = adc_init();
+	if (err) {
+		LOG_ERR("ADC init failed (err %d)\n", err);
+		app_evt_raise(APP_ERR_ADC);
+	}
+
+	// LED work items are statically initialized, so sampling can use them before
+	// the GPIO is configured here; blinks are skipped until then.
 	err = led_init();
 	if (err) {
 		LOG_ERR("LEDs init failed (err %d)\n", err);
 		app_evt_raise(APP_ERR_LED);
-		return 0;
 	}
 
 	// Initialize the button toggle BLE advertising
@@ -88,7 +154,6 @@ int main(void)
 	if (err) {
 		LOG_ERR("Button init failed (err %d)\n", err);
 		app_evt_raise(APP_ERR_BUTTON);
-		return 0;
 	}
 
 	/* Start watchdog (feeds periodically in background) */
@@ -97,29 +162,10 @@ int main(void)
 		LOG_WRN("Watchdog init failed (%d)", err);
 	}
 
-	/* Initialize BLE stack and register GATT/service in ble.c */
-	err = ble_init();
-	if (err) {
-		LOG_ERR("Bluetooth init failed (err %d)\n", err);
-		app_evt_raise(APP_ERR_BLE);
-		return 0;
-	}
-
-	if (IS_ENABLED(CONFIG_SETTINGS)) {
-		err = settings_load();
-		if (err) {
-			LOG_ERR("settings: load failed (%d)", err);
-		}
-	}
-
-	// Initialize the ADC for battery voltage measurement
-	err = adc_init();
-	if (err) {
-		LOG_ERR("ADC init failed (err %d)\n", err);
-		app_evt_raise(APP_ERR_ADC);
-		return 0;
-	}
-	// Start BLE advertising if enabled and not already started
-	ble_advertising_start();
+	/* Bring up BLE asynchronously; settings load and advertising follow in ble_ready().
+	 * ble_init() logs and raises APP_ERR_BLE itself on failure.
+	 */
+	(void)ble_init(ble_ready);
 
+	return 0;
 }
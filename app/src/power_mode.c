@@ -0,0 +1,153 @@
+/* Battery-aware power mode manager: filtered voltage with hysteresis selects a power profile */
+
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/gap.h>
+#include <zephyr/logging/log.h>
+#include "app.h"
+#include "ble.h"
+#include "power_mode.h"
+
+LOG_MODULE_REGISTER(PWR_MODE, CONFIG_APP_LOG_LEVEL);
+
+BUILD_ASSERT(CONFIG_APP_PWR_CRITICAL_MV < CONFIG_APP_PWR_CONSERVE_MV,
+             "critical threshold must be below the conserve threshold");
+
+static const struct power_profile profiles[PWR_MODE_COUNT] = {
+    [PWR_MODE_NORMAL] = {
+        .sample_interval_mult = 1,
+        .adv_interval_min = BT_GAP_ADV_FAST_INT_MIN_2,  /* 100 ms */
+        .adv_interval_max = BT_GAP_ADV_FAST_INT_MAX_2,  /* 150 ms */
+        .led_idle = true,
+        .led_sample = true,
+        .notify_every = 1,
+    },
+    [PWR_MODE_CONSERVE] = {
+        .sample_interval_mult = CONFIG_APP_PWR_CONSERVE_INTERVAL_MULT,
+        .adv_interval_min = BT_GAP_ADV_SLOW_INT_MIN,    /* 1 s */
+        .adv_interval_max = BT_GAP_ADV_SLOW_INT_MAX,    /* 1.2 s */
+        .led_idle = false,
+        .led_sample = true,
+        .notify_every = CONFIG_APP_PWR_CONSERVE_NOTIFY_EVERY,
+    },
+    [PWR_MODE_CRITICAL] = {
+        .sample_interval_mult = CONFIG_APP_PWR_CRITICAL_INTERVAL_MULT,
+        .adv_interval_min = 0x1900,                     /* 4 s */
+        .adv_interval_max = 0x1F40,                     /* 5 s */
+        .led_idle = false,
+        .led_sample = false,
+        .notify_every = CONFIG_APP_PWR_CRITICAL_NOTIFY_EVERY,
+    },
+};
+
+static const char *const mode_names[PWR_MODE_COUNT] = {
+    [PWR_MODE_NORMAL]   = "normal",
+    [PWR_MODE_CONSERVE] = "conserve",
+    [PWR_MODE_CRITICAL] = "critical",
+};
+
+static enum power_mode mode = PWR_MODE_NORMAL;
+static uint32_t base_interval_ms;
+static uint8_t base_notify_every = 1;
+static int32_t filtered_mv;     /* EWMA, scaled by 2^FILTER_SHIFT */
+static bool filter_primed;
+static uint32_t notify_skip;
+
+#define FILTER_SHIFT CONFIG_APP_PWR_FILTER_SHIFT
+
+static void apply_profile(void)
+{
+    const struct power_profile *p = &profiles[mode];
+
+    adc_set_sample_interval(base_interval_ms * p->sample_interval_mult);
+    led_set_patterns(p->led_idle, p->led_sample);
+    ble_set_adv_interval(p->adv_interval_min, p->adv_interval_max);
+    notify_skip = 0;
+}
+
+/* Next mode for a filtered voltage; leaving a low mode needs the threshold plus hysteresis */
+static enum power_mode next_mode(int32_t mv)
+{
+    const int32_t hyst = CONFIG_APP_PWR_HYSTERESIS_MV;
+
+    switch (mode) {
+    case PWR_MODE_NORMAL:
+        if (mv < CONFIG_APP_PWR_CRITICAL_MV) {
+            return PWR_MODE_CRITICAL;
+        }
+        if (mv < CONFIG_APP_PWR_CONSERVE_MV) {
+            return PWR_MODE_CONSERVE;
+        }
+        break;
+    case PWR_MODE_CONSERVE:
+        if (mv < CONFIG_APP_PWR_CRITICAL_MV) {
+            return PWR_MODE_CRITICAL;
+        }
+        if (mv >= CONFIG_APP_PWR_CONSERVE_MV + hyst) {
+            return PWR_MODE_NORMAL;
+        }
+        break;
+    case PWR_MODE_CRITICAL:
+        if (mv >= CONFIG_APP_PWR_CONSERVE_MV + hyst) {
+            return PWR_MODE_NORMAL;
+        }
+        if (mv >= CONFIG_APP_PWR_CRITICAL_MV + hyst) {
+            return PWR_MODE_CONSERVE;
+        }
+        break;
+    default:
+        break;
+    }
+    return mode;
+}
+
+void power_mode_init(uint32_t interval_ms, uint8_t notify_every)
+{
+    base_interval_ms = interval_ms;
+    base_notify_every = MAX(notify_every, 1);
+    apply_profile();
+}
+
+void power_mode_update(int32_t mv)
+{
+    if (!filter_primed) {
+        filtered_mv = mv << FILTER_SHIFT;
+        filter_primed = true;
+    } else {
+        filtered_mv += mv - (filtered_mv >> FILTER_SHIFT);
+    }
+
+    enum power_mode next = next_mode(filtered_mv >> FILTER_SHIFT);
+
+    if (next == mode) {
+        return;
+    }
+    LOG_INF("power mode %s -> %s at %d mV", mode_names[mode], mode_names[next],
+            filtered_mv >> FILTER_SHIFT);
+    mode = next;
+    apply_profile();
+    notify_power_mode((uint8_t)mode);
+}
+
+bool power_mode_notify_due(void)
+{
+    if (++notify_skip >= (uint32_t)profiles[mode].notify_every * base_notify_every) {
+        notify_skip = 0;
+        return true;
+    }
+    return false;
+}
+
+enum power_mode power_mode_get(void)
+{
+    return mode;
+}
+
+const struct power_profile *power_mode_profile(void)
+{
+    return &profiles[mode];
+}
+
+const char *power_mode_name(enum power_mode m)
+{
+    return m < PWR_MODE_COUNT ? mode_names[m] : "?";
+}
@@ -0,0 +1,166 @@
+/* Fault recovery supervisor: per-subsystem restart with exponential back-off */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/reboot.h>
+#include <zephyr/logging/log.h>
+#include "app.h"
+#include "app_events.h"
+#include "ble.h"
+#include "recovery.h"
+
+LOG_MODULE_REGISTER(RECOVERY, CONFIG_APP_LOG_LEVEL);
+
+#define STABLE_MS ((int64_t)CONFIG_APP_RECOVERY_STABLE_S * 1000)
+
+struct subsys {
+    const char *name;
+    uint32_t bit;
+    /* Stop the subsystem's periodic work while it is faulted; may be NULL */
+    void (*quiesce)(void);
+    /* Re-initialize in place; NULL if clearing the fault is enough */
+    int (*recover)(void);
+    struct k_work_delayable work;
+    struct k_work done_work;    /* completes a RECOVERY_IN_PROGRESS attempt */
+    uint32_t attempts;      /* consecutive attempts since the subsystem was last stable */
+    int64_t last_ok_ms;     /* uptime of the last successful recovery */
+    bool pending;
+    bool in_progress;       /* waiting for recovery_done(); the work item is its timeout */
+    int done_err;
+};
+
+static struct subsys subsystems[RECOVERY_SUBSYS_COUNT] = {
+    [RECOVERY_ADC]    = { "adc", APP_ERR_ADC, adc_sampling_stop, adc_recover },
+    [RECOVERY_BLE]    = { "ble", APP_ERR_BLE, NULL, ble_recover },
+    [RECOVERY_LED]    = { "led", APP_ERR_LED, NULL, led_init },
+    [RECOVERY_BUTTON] = { "button", APP_ERR_BUTTON, NULL, button_init },
+};
+
+static struct recovery_stats stats;
+
+static uint32_t backoff_ms(uint32_t attempt)
+{
+    uint64_t ms = (uint64_t)CONFIG_APP_RECOVERY_BACKOFF_MS << MIN(attempt, 20U);
+
+    return (uint32_t)MIN(ms, (uint64_t)CONFIG_APP_RECOVERY_BACKOFF_MAX_MS);
+}
+
+static void schedule(struct subsys *s)
+{
+    if (s->attempts >= CONFIG_APP_RECOVERY_MAX_ATTEMPTS) {
+        LOG_ERR("%s: recovery budget exhausted after %u attempts, resetting", s->name,
+                s->attempts);
+        LOG_PANIC();
+        sys_reboot(SYS_REBOOT_COLD);
+    }
+    uint32_t delay = backoff_ms(s->attempts);
+
+    LOG_WRN("%s: recovery attempt %u in %u ms", s->name, s->attempts + 1, delay);
+    k_work_reschedule(&s->work, K_MSEC(delay));
+}
+
+/* Both work items run on the system workqueue, so this never runs concurrently */
+static void finish(struct subsys *s, int err)
+{
+    if (err) {
+        atomic_or(&app_evt_bits, s->bit);
+        LOG_WRN("%s: recovery failed (%d)", s->name, err);
+        schedule(s);
+        return;
+    }
+
+    s->pending = false;
+    s->last_ok_ms = k_uptime_get();
+    stats.recovered[s - subsystems]++;
+    LOG_INF("%s: recovered after %u attempt(s)", s->name, s->attempts);
+
+    if (!app_evt_has(APP_ERR_ANY)) {
+        led_error_clear();
+    }
+}
+
+static void recovery_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct subsys *s = CONTAINER_OF(dwork, struct subsys, work);
+    int err = 0;
+
+    if (s->in_progress) {
+        /* recovery_done() never came */
+        s->in_progress = false;
+        finish(s, -ETIMEDOUT);
+        return;
+    }
+    s->attempts++;
+    /* Clear first so the restarted subsystem does not see its own stale fault */
+    app_evt_clear(s->bit);
+    if (s->recover) {
+        err = s->recover();
+    }
+    if (err == RECOVERY_IN_PROGRESS) {
+        s->in_progress = true;
+        k_work_reschedule(&s->work, K_MSEC(CONFIG_APP_RECOVERY_COMPLETE_TIMEOUT_MS));
+        return;
+    }
+    finish(s, err);
+}
+
+static void done_work_handler(struct k_work *work)
+{
+    struct subsys *s = CONTAINER_OF(work, struct subsys, done_work);
+
+    /* Not waiting (e.g. the first init at boot) or already timed out */
+    if (!s->in_progress) {
+        return;
+    }
+    s->in_progress = false;
+    (void)k_work_cancel_delayable(&s->work);
+    finish(s, s->done_err);
+}
+
+void recovery_done(enum recovery_subsys subsys, int err)
+{
+    if (subsys >= RECOVERY_SUBSYS_COUNT) {
+        return;
+    }
+    subsystems[subsys].done_err = err;
+    k_work_submit(&subsystems[subsys].done_work);
+}
+
+void recovery_handle(uint32_t err_bits)
+{
+    int64_t now = k_uptime_get();
+
+    for (int i = 0; i < RECOVERY_SUBSYS_COUNT; i++) {
+        struct subsys *s = &subsystems[i];
+
+        if (!(err_bits & s->bit) || s->pending) {
+            continue;
+        }
+        s->pending = true;
+        stats.faults[i]++;
+        /* A fault long after the last recovery starts a fresh budget */
+        if (s->last_ok_ms == 0 || now - s->last_ok_ms >= STABLE_MS) {
+            s->attempts = 0;
+        }
+        if (s->quiesce) {
+            s->quiesce();
+        }
+        schedule(s);
+    }
+}
+
+void recovery_stats_get(struct recovery_stats *out)
+{
+    *out = stats;
+}
+
+static int recovery_init(void)
+{
+    for (int i = 0; i < RECOVERY_SUBSYS_COUNT; i++) {
+        k_work_init_delayable(&subsystems[i].work, recovery_work_handler);
+        k_work_init(&subsystems[i].done_work, done_work_handler);
+    }
+    return 0;
+}
+
+SYS_INIT(recovery_init, APPLICATION, 0);
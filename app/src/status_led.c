@@ -4,20 +4,34 @@ LOG_MODULE_REGISTER(STATUS_LED, CONFIG_APP_LOG_LEVEL);
 #include <zephyr/kernel.h>
 #include "app.h"
 #include "app_events.h"
+#include "boot_prof.h"
+#include "timer_svc.h"
+#include "energy.h"
 
-struct k_work_delayable led_idle_work;
-struct k_work_delayable led_sample_work;
-struct k_work_delayable led_error_work;
+static void idle_work(struct k_work *work);
+static void sample_work(struct k_work *work);
+static void error_work(struct k_work *work);
+
+/* Statically initialized so other modules may schedule them before led_init() runs */
+K_WORK_DELAYABLE_DEFINE(led_idle_work, idle_work);
+K_WORK_DELAYABLE_DEFINE(led_sample_work, sample_work);
+K_WORK_DELAYABLE_DEFINE(led_error_work, error_work);
+
+/* Set once the LED GPIO is configured; blinks requested earlier are dropped */
+static bool led_ready;
+/* Patterns enabled by the active power profile */
+static bool idle_blink_enabled = true;
+static bool sample_blink_enabled = true;
 
 /* Locate led0 as alias or label by that name for paired status*/
 #if DT_NODE_EXISTS(DT_ALIAS(led0))
 #define LED0 DT_ALIAS(led0)
-#elif DT_NODE_EXISTS(DT_ALIAS(led-status))
-#define LED0 DT_ALIAS(led-status)
+#elif DT_NODE_EXISTS(DT_ALIAS(led_status))
+#define LED0 DT_ALIAS(led_status)
 #elif DT_NODE_EXISTS(DT_NODELABEL(led0))
 #define LED0 DT_NODELABEL(led0)
-#elif DT_NODE_EXISTS(DT_NODELABEL(led-status))
-#define LED0 DT_NODELABEL(led-status)
+#elif DT_NODE_EXISTS(DT_NODELABEL(led_status))
+#define LED0 DT_NODELABEL(led_status)
 #else
 #define LED0 DT_INVALID_NODE
 #endif
@@ -32,40 +46,68 @@ K_MUTEX_DEFINE(led_mutex);
 static const struct device *led0_dev = DEVICE_DT_GET(LED0_DEV);
 #endif /* LED0 */
 
+static bool led_is_on;
+
+//Drive the LED and account its on-time
+static void led_set(bool on)
+{
+    gpio_pin_set(led0_dev, LED0_PIN, on);
+    led_is_on = on;
+    energy_set(ENERGY_LED, on);
+}
+
 //work handlers for different LED blink patterns 
 //Blink patterns indicate different operation modes
-//Idle mode - single short blink every sample_interval_ms/2
+//Idle mode - single short blink every sample_interval_ms/2 (driven by the timer service)
 //Sample mode - double short blink every sample_interval_ms/2
 //Error mode - fast continuous blink
 
 //This work is independent of sample and error work, so it can be scheduled anytime
 static void idle_work(struct k_work *work)
 {
+    if (!led_ready) {
+        return;
+    }
     //Lock the mutex to prevent simultaneous access to the LED from different work items
 	k_mutex_lock(&led_mutex, K_FOREVER);
     //blink the LED once
-    gpio_pin_set(led0_dev, LED0_PIN, 1);
+    led_set(true);
     k_sleep(K_MSEC(50));
-    gpio_pin_set(led0_dev, LED0_PIN, 0);
+    led_set(false);
     k_mutex_unlock(&led_mutex);// release the mutex
-    
-    //reschedule the idle work to run again after sample_interval_ms/2
-    k_work_reschedule(&led_idle_work, K_MSEC(sample_interval_ms/2));
+}
+
+//Periodic tick from the timer service. The blink itself sleeps, so hand it to its own work item
+static void idle_tick(struct timer_svc_task *task)
+{
+    k_work_reschedule(&led_idle_work, K_NO_WAIT);
+}
+
+TIMER_SVC_TASK_DEFINE(led_idle_task, idle_tick);
+
+static void idle_blink_start(void)
+{
+    //its phase is not important so give it generous slack
+    timer_svc_start(&led_idle_task, sample_interval_ms / 2,
+                    (sample_interval_ms / 2) * CONFIG_APP_TIMER_SVC_SLACK_PCT / 100, 0);
 }
 
 //This work is scheduled when a sample is taken
 //It blinks the LED twice quickly to indicate a sample event. It does not reschedule itself
 static void sample_work(struct k_work *work)
 {
+    if (!led_ready || !sample_blink_enabled) {
+        return;
+    }
     //Lock the mutex to prevent simultaneous access to the LED from different work items
     k_mutex_lock(&led_mutex, K_FOREVER);
-	gpio_pin_set(led0_dev, LED0_PIN, 1);
+	led_set(true);
     k_sleep(K_MSEC(50));
-    gpio_pin_set(led0_dev, LED0_PIN, 0);
+    led_set(false);
     k_sleep(K_MSEC(50));
-    gpio_pin_set(led0_dev, LED0_PIN, 1);
+    led_set(true);
     k_sleep(K_MSEC(50));
-    gpio_pin_set(led0_dev, LED0_PIN, 0);
+    led_set(false);
     k_mutex_unlock(&led_mutex);// release the mutex
 	//printk("new threshold value is... %d\n",threshold_do_f16 );
     
@@ -76,7 +118,10 @@ static void sample_work(struct k_work *work)
 //It also cancels the other two work items to prevent interference as error indication is critical unless reset
 static void error_work(struct k_work *work)
 {
-	gpio_pin_toggle(led0_dev, LED0_PIN);
+    if (!led_ready) {
+        return;
+    }
+	led_set(!led_is_on);
 	//printk("new threshold value is... %d\n",threshold_do_f16 );
     k_work_reschedule(&led_error_work, K_MSEC(100));
 }
@@ -84,9 +129,6 @@ static void error_work(struct k_work *work)
 int led_init(void)
 {
 	int err = 0;
-    k_work_init_delayable(&led_idle_work, idle_work);
-    k_work_init_delayable(&led_sample_work, sample_work);
-    k_work_init_delayable(&led_error_work, error_work);
 
 #if DT_NODE_EXISTS(LED0)
 	if(!device_is_ready(led0_dev)) 
@@ -111,7 +153,41 @@ int led_init(void)
         return err;
     }
 
-    k_work_reschedule(&led_idle_work, K_NO_WAIT); //start the idle blink work
+    led_ready = true;
+    boot_prof_mark(BOOT_STAGE_LED_READY);
+    if (idle_blink_enabled) {
+        idle_blink_start();
+    }
 #endif
 return err;
-}
\ No newline at end of file
+}
+
+void led_error_clear(void)
+{
+    k_work_cancel_delayable(&led_error_work);
+    if (!led_ready) {
+        return;
+    }
+    k_mutex_lock(&led_mutex, K_FOREVER);
+    led_set(false);
+    k_mutex_unlock(&led_mutex);
+    if (idle_blink_enabled) {
+        idle_blink_start();
+    }
+}
+
+//Select which patterns run; used by the power mode manager. The error pattern is never suppressed
+void led_set_patterns(bool idle_blink, bool sample_blink)
+{
+    idle_blink_enabled = idle_blink;
+    sample_blink_enabled = sample_blink;
+    if (!led_ready || app_evt_has(APP_ERR_ANY)) {
+        return;
+    }
+    if (idle_blink) {
+        idle_blink_start();
+    } else {
+        timer_svc_stop(&led_idle_task);
+        k_work_cancel_delayable(&led_idle_work);
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * Stress scenario for stack sizing
+ *
+ * Drives every path that runs on an application thread as hard as the
+ * firmware allows: minimum sample interval with a calibration on every scan,
+ * transient arm/disarm, configuration saves and LED faults through the
+ * recovery supervisor. The button thread only runs on real edges, so press
+ * the button (short, long, double) during the run. After
+ * CONFIG_APP_STRESS_DURATION_S the stack peaks are reported and the scenario
+ * stops; the firmware keeps running.
+ *
+ * Target only: on ARCH_POSIX every thread runs on a host pthread stack, so
+ * the thread analyzer sees an almost unused Zephyr stack buffer.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "app.h"
+#include "adc_cal.h"
+#include "app_config.h"
+#include "app_events.h"
+#include "buttons.h"
+#include "footprint.h"
+#include "transient.h"
+
+LOG_MODULE_REGISTER(STRESS, CONFIG_APP_LOG_LEVEL);
+
+#define TICK_MS 50
+#define END_MS ((int64_t)CONFIG_APP_STRESS_DURATION_S * 1000)
+
+static uint32_t ticks;
+static int64_t start_ms;
+
+static void stress_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(stress_work, stress_work_handler);
+
+static void stress_cfg_touch(void)
+{
+    struct app_cfg cfg;
+
+    app_config_get(&cfg);
+
+    /* Alternate the threshold so that every save really writes a new record */
+    cfg.sample_interval_ms = CONFIG_APP_STRESS_SAMPLE_INTERVAL_MS;
+    cfg.threshold_mv = (ticks / 20) & 1 ? cfg.threshold_mv + 1 : cfg.threshold_mv - 1;
+    cfg.notify_every = 1;
+    if (app_config_set(&cfg) == 0) {
+        app_config_apply();
+    }
+}
+
+static void stress_work_handler(struct k_work *work)
+{
+    ticks++;
+
+    /* Calibration makes every scan take the longer path */
+    adc_cal_request();
+
+#if IS_ENABLED(CONFIG_APP_TRANSIENT_CAPTURE)
+    if (ticks % 10 == 0) {
+        transient_arm(!transient_is_armed());
+    }
+#endif
+    if (ticks % 20 == 0) {
+        stress_cfg_touch();
+    }
+    if (ticks % 40 == 0) {
+        app_evt_raise(APP_ERR_LED);
+    }
+
+    if (k_uptime_get() - start_ms < END_MS) {
+        k_work_schedule(&stress_work, K_MSEC(TICK_MS));
+        return;
+    }
+
+    LOG_INF("stress done: %u ticks", ticks);
+    footprint_stack_report();
+}
+
+static int stress_init(void)
+{
+    /* Exercise gesture classification without letting it change the run */
+    for (int g = 0; g < BUTTON_GESTURE_COUNT; g++) {
+        button_set_action(g, BUTTON_ACTION_NONE);
+    }
+    LOG_INF("stress: %u s at %u ms sampling", CONFIG_APP_STRESS_DURATION_S,
+            CONFIG_APP_STRESS_SAMPLE_INTERVAL_MS);
+    start_ms = k_uptime_get();
+    /* Let main() finish bring-up first */
+    k_work_schedule(&stress_work, K_SECONDS(1));
+    return 0;
+}
+
+SYS_INIT(stress_init, APPLICATION, 99);
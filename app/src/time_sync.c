@@ -0,0 +1,121 @@
+/* Time synchronization: offset and drift of the local clock against a reference */
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "time_sync.h"
+
+LOG_MODULE_REGISTER(TIME_SYNC, CONFIG_APP_LOG_LEVEL);
+
+#define MIN_SPAN_US ((int64_t)CONFIG_APP_TIME_SYNC_MIN_SPAN_S * USEC_PER_SEC)
+#define MAX_DRIFT_PPB ((int64_t)CONFIG_APP_TIME_SYNC_MAX_DRIFT_PPM * 1000)
+#define PPB 1000000000LL
+
+static struct k_spinlock lock;
+static bool synced;
+static bool drift_valid;
+/* Latest sync: the mapping is projected from here */
+static int64_t anchor_local_us;
+static int64_t anchor_ref_us;
+/* Start of the span over which the next drift sample is measured */
+static int64_t span_local_us;
+static int64_t span_ref_us;
+static struct time_sync_stats stats;
+
+/* Must be called with lock held */
+static int64_t project_locked(int64_t local_us)
+{
+    int64_t dt = local_us - anchor_local_us;
+
+    /* dt stays well below 2^63 / MAX_DRIFT_PPB for any realistic uptime */
+    return anchor_ref_us + dt + (dt * stats.drift_ppb) / PPB;
+}
+
+/* Must be called with lock held. Folds the span ending at (now, ref_us) into the drift estimate. */
+static void update_drift_locked(int64_t now, int64_t ref_us)
+{
+    int64_t span = now - span_local_us;
+    int64_t diff;
+
+    if (span < MIN_SPAN_US) {
+        /* Too short for the write latency jitter to average out; keep the span open */
+        return;
+    }
+    diff = (ref_us - span_ref_us) - span;
+    span_local_us = now;
+    span_ref_us = ref_us;
+
+    if (llabs(diff) > span * MAX_DRIFT_PPB / PPB) {
+        /* Not a crystal: the reference clock was stepped. Start a fresh span. */
+        LOG_WRN("reference jumped by %lld us, drift sample discarded", diff);
+        return;
+    }
+
+    int32_t sample = (int32_t)(diff * PPB / span);
+
+    if (!drift_valid) {
+        stats.drift_ppb = sample;
+        drift_valid = true;
+    } else {
+        stats.drift_ppb += (sample - stats.drift_ppb) / (1 << CONFIG_APP_TIME_SYNC_FILTER_SHIFT);
+    }
+}
+
+int time_sync_set(int64_t ref_ms)
+{
+    int64_t now = time_sync_local_us();
+    int64_t ref_us = ref_ms * USEC_PER_MSEC;
+
+    if (ref_ms <= 0) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (synced) {
+        int64_t err = project_locked(now) - ref_us;
+
+        stats.last_error_us = (int32_t)CLAMP(err, INT32_MIN, INT32_MAX);
+        update_drift_locked(now, ref_us);
+    } else {
+        span_local_us = now;
+        span_ref_us = ref_us;
+    }
+    /* Step to the new reference; the drift only bridges the gap until the next sync */
+    anchor_local_us = now;
+    anchor_ref_us = ref_us;
+    synced = true;
+    stats.syncs++;
+
+    struct time_sync_stats st = stats;
+
+    k_spin_unlock(&lock, key);
+
+    LOG_INF("sync #%u: error %d us, drift %d ppb", st.syncs, st.last_error_us, st.drift_ppb);
+    return 0;
+}
+
+bool time_sync_is_synced(void)
+{
+    return synced;
+}
+
+int64_t time_sync_abs_ms(int64_t local_us)
+{
+    int64_t abs_us = 0;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (synced) {
+        abs_us = project_locked(local_us);
+    }
+    k_spin_unlock(&lock, key);
+    return abs_us / USEC_PER_MSEC;
+}
+
+void time_sync_stats_get(struct time_sync_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    *out = stats;
+    k_spin_unlock(&lock, key);
+}
@@ -0,0 +1,182 @@
+/* Wakeup-coalescing timer service (runs on the system workqueue) */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/logging/log.h>
+#include "timer_svc.h"
+
+LOG_MODULE_REGISTER(TIMER_SVC, CONFIG_APP_LOG_LEVEL);
+
+static sys_slist_t task_list = SYS_SLIST_STATIC_INIT(&task_list);
+static struct k_spinlock lock;
+
+/* Wakeups and task runs, leaving out the rate report's own runs */
+static uint32_t wakeups;
+static uint32_t runs;
+static uint32_t window_wakeups;
+static uint32_t window_runs;
+static int64_t window_start_ms;
+
+static void svc_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(svc_work, svc_work_handler);
+
+/* Must be called with lock held. Arms the service for the earliest due time. */
+static void replan_locked(void)
+{
+    struct timer_svc_task *t;
+    int64_t wake = INT64_MAX;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&task_list, t, node) {
+        if (t->active && t->due_ms < wake) {
+            wake = t->due_ms;
+        }
+    }
+
+    if (wake == INT64_MAX) {
+        (void)k_work_cancel_delayable(&svc_work);
+        return;
+    }
+
+    int64_t delay = wake - k_uptime_get();
+
+    k_work_reschedule(&svc_work, K_MSEC(MAX(delay, 0)));
+}
+
+static void svc_work_handler(struct k_work *work)
+{
+    struct timer_svc_task *t;
+    int64_t now = k_uptime_get();
+    bool counted = false;
+
+    /* Tasks are only ever appended, so walking the list unlocked is safe;
+     * callbacks may start/stop tasks (including themselves).
+     */
+    SYS_SLIST_FOR_EACH_CONTAINER(&task_list, t, node) {
+        bool run = false;
+        k_spinlock_key_t key = k_spin_lock(&lock);
+
+        /* Run every task whose window [due - slack, due] has opened. The next due
+         * time keeps the phase, so a task pulled forward once is pulled forward
+         * into the same wakeup every period.
+         */
+        if (t->active && t->due_ms - t->slack_ms <= now) {
+            t->due_ms += t->period_ms;
+            /* Skip missed periods rather than running a burst to catch up */
+            if (t->due_ms - t->slack_ms <= now) {
+                t->due_ms = now + t->period_ms;
+            }
+            t->runs++;
+            run = true;
+            if (!t->diag) {
+                runs++;
+                counted = true;
+            }
+        }
+        k_spin_unlock(&lock, key);
+
+        if (run) {
+            t->fn(t);
+        }
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (counted) {
+        wakeups++;
+    }
+    replan_locked();
+    k_spin_unlock(&lock, key);
+}
+
+void timer_svc_start(struct timer_svc_task *task, uint32_t period_ms, uint32_t slack_ms,
+                     uint32_t delay_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (!task->registered) {
+        sys_slist_append(&task_list, &task->node);
+        task->registered = true;
+    }
+    task->period_ms = MAX(period_ms, 1U);
+    /* Slack of a whole period would let a task run twice in one wakeup's window */
+    task->slack_ms = MIN(slack_ms, task->period_ms - 1);
+    task->due_ms = k_uptime_get() + delay_ms;
+    task->active = true;
+    replan_locked();
+    k_spin_unlock(&lock, key);
+}
+
+void timer_svc_stop(struct timer_svc_task *task)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    task->active = false;
+    replan_locked();
+    k_spin_unlock(&lock, key);
+}
+
+void timer_svc_set_period(struct timer_svc_task *task, uint32_t period_ms, uint32_t slack_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    task->period_ms = MAX(period_ms, 1U);
+    task->slack_ms = MIN(slack_ms, task->period_ms - 1);
+    if (task->active) {
+        replan_locked();
+    }
+    k_spin_unlock(&lock, key);
+}
+
+bool timer_svc_is_active(const struct timer_svc_task *task)
+{
+    return task->active;
+}
+
+static uint32_t rate_mhz(uint32_t count, int64_t window_ms)
+{
+    return window_ms > 0 ? (uint32_t)(((uint64_t)count * 1000000U) / window_ms) : 0;
+}
+
+void timer_svc_stats_get(struct timer_svc_stats *stats)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int64_t window_ms = k_uptime_get() - window_start_ms;
+
+    stats->wakeups = wakeups;
+    stats->coalesced_mhz = rate_mhz(wakeups - window_wakeups, window_ms);
+    stats->uncoalesced_mhz = rate_mhz(runs - window_runs, window_ms);
+    k_spin_unlock(&lock, key);
+}
+
+#if CONFIG_APP_TIMER_SVC_REPORT_INTERVAL_S > 0
+static void report_fn(struct timer_svc_task *task)
+{
+    struct timer_svc_stats st;
+
+    timer_svc_stats_get(&st);
+    LOG_INF("wakeups: %u.%03u/s, task runs: %u.%03u/s (%u wakeups total)",
+            st.coalesced_mhz / 1000, st.coalesced_mhz % 1000,
+            st.uncoalesced_mhz / 1000, st.uncoalesced_mhz % 1000, st.wakeups);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    window_wakeups = wakeups;
+    window_runs = runs;
+    window_start_ms = k_uptime_get();
+    k_spin_unlock(&lock, key);
+}
+
+static TIMER_SVC_TASK_DEFINE(report_task, report_fn);
+
+static int timer_svc_report_init(void)
+{
+    uint32_t period = CONFIG_APP_TIMER_SVC_REPORT_INTERVAL_S * 1000U;
+
+    /* The report is never urgent; let it ride along with any other wakeup */
+    report_task.diag = true;
+    timer_svc_start(&report_task, period, period / 2, period);
+    return 0;
+}
+
+SYS_INIT(timer_svc_report_init, APPLICATION, 0);
+#endif
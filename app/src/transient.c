@@ -0,0 +1,255 @@
+/* Triggered transient capture: continuous high-rate sampling into a pre-trigger ring */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "app.h"
+#include "ble.h"
+#include "energy.h"
+#include "transient.h"
+#include "time_sync.h"
+
+LOG_MODULE_REGISTER(TRANSIENT, CONFIG_APP_LOG_LEVEL);
+
+#define PRE  CONFIG_APP_TRANSIENT_PRE_SAMPLES
+#define POST CONFIG_APP_TRANSIENT_POST_SAMPLES
+
+/* Notification payload: capture id (u16), byte offset (u16), then up to CHUNK bytes.
+ * Sized for the default ATT MTU of 23.
+ */
+#define CHUNK 16
+
+static atomic_t armed;
+static K_SEM_DEFINE(arm_sem, 0, 1);
+static atomic_t dropped;
+
+/* Written by the ADC on every sampling, consumed in the sampling callback (ISR) */
+static int16_t sample;
+static int16_t ring[TRANSIENT_WINDOW];
+static uint32_t ring_pos;
+static uint32_t ring_filled;
+static int32_t post_left;           /* -1 while waiting for a trigger */
+static int16_t prev;
+/* time_sync_local_us() of the trigger sample; sample timestamps use the same base */
+static int64_t trig_local_us;
+
+/* Trigger thresholds converted to raw counts once per arm */
+static int32_t level_raw;
+static int32_t slope_raw;
+
+K_MSGQ_DEFINE(capture_q, sizeof(struct transient_capture), CONFIG_APP_TRANSIENT_QUEUE_DEPTH, 4);
+
+static bool triggered(int16_t before, int16_t now)
+{
+    /* Falling through the level, or a drop steeper than the slope within one sample */
+    if (CONFIG_APP_TRANSIENT_TRIGGER_LEVEL_MV > 0 && before >= level_raw && now < level_raw) {
+        return true;
+    }
+    if (CONFIG_APP_TRANSIENT_TRIGGER_SLOPE_MV > 0 && (before - now) >= slope_raw) {
+        return true;
+    }
+    return false;
+}
+
+/* Runs in ADC interrupt context after every sampling; keep it short */
+static enum adc_action sampling_cb(const struct device *dev, const struct adc_sequence *seq,
+                                   uint16_t sampling_index)
+{
+    int16_t s = sample;
+
+    if (!atomic_get(&armed)) {
+        return ADC_ACTION_FINISH;
+    }
+
+    ring[ring_pos] = s;
+    ring_pos = (ring_pos + 1) % TRANSIENT_WINDOW;
+    if (ring_filled < TRANSIENT_WINDOW) {
+        ring_filled++;
+    }
+
+    if (post_left < 0) {
+        /* The slope test needs a previous sample, even with a single pre-trigger sample */
+        if (ring_filled >= MAX(PRE, 2) && triggered(prev, s)) {
+            trig_local_us = time_sync_local_us();
+            post_left = POST;
+        }
+    } else if (--post_left <= 0) {
+        post_left = 0;
+        /* Window complete: the ring now holds PRE + POST samples ending here */
+        return ADC_ACTION_FINISH;
+    }
+
+    prev = s;
+    return ADC_ACTION_REPEAT;
+}
+
+static int32_t mv_to_raw(const struct adc_dt_spec *spec, int32_t mv)
+{
+    int32_t full_scale_mv = BIT(spec->resolution);
+
+    if (adc_raw_to_millivolts_dt(spec, &full_scale_mv) < 0 || full_scale_mv <= 0) {
+        return 0;
+    }
+    return (mv * (int32_t)BIT(spec->resolution)) / full_scale_mv;
+}
+
+/* Unroll the frozen ring into a capture record and queue it for download */
+static void queue_capture(const struct adc_dt_spec *spec)
+{
+    static struct transient_capture cap;
+
+    cap.trigger_ms = (uint32_t)(trig_local_us / USEC_PER_MSEC);
+    cap.trigger_abs_ms = time_sync_abs_ms(trig_local_us);
+    cap.interval_us = CONFIG_APP_TRANSIENT_INTERVAL_US;
+    cap.pre_samples = PRE;
+    cap.post_samples = POST;
+    for (uint32_t i = 0; i < TRANSIENT_WINDOW; i++) {
+        int32_t v = ring[(ring_pos + i) % TRANSIENT_WINDOW];
+
+        if (!spec->channel_cfg.differential) {
+            v = (uint16_t)v;
+        }
+        (void)adc_raw_to_millivolts_dt(spec, &v);
+        cap.mv[i] = (uint16_t)CLAMP(v, 0, UINT16_MAX);
+    }
+
+    if (k_msgq_put(&capture_q, &cap, K_NO_WAIT)) {
+        atomic_inc(&dropped);
+        LOG_WRN("capture dropped, download queue full");
+        return;
+    }
+    LOG_INF("transient captured at %u ms", cap.trigger_ms);
+    transient_download_kick();
+}
+
+static void transient_thread(void *p1, void *p2, void *p3)
+{
+    const struct adc_dt_spec *spec = adc_battery_channel();
+    const struct adc_sequence_options opts = {
+        .interval_us = CONFIG_APP_TRANSIENT_INTERVAL_US,
+        .callback = sampling_cb,
+        .extra_samplings = 0,
+    };
+    struct adc_sequence seq = {
+        .options = &opts,
+        .channels = BIT(spec->channel_id),
+        .buffer = &sample,
+        .buffer_size = sizeof(sample),
+        .resolution = spec->resolution,
+        .oversampling = spec->oversampling,
+    };
+
+    for (;;) {
+        k_sem_take(&arm_sem, K_FOREVER);
+        if (!atomic_get(&armed)) {
+            continue;
+        }
+
+        level_raw = mv_to_raw(spec, CONFIG_APP_TRANSIENT_TRIGGER_LEVEL_MV);
+        slope_raw = MAX(mv_to_raw(spec, CONFIG_APP_TRANSIENT_TRIGGER_SLOPE_MV), 1);
+
+        /* Take the ADC over from periodic sampling */
+        adc_sampling_pause();
+        LOG_INF("capture armed: %u us/sample, %u+%u samples", CONFIG_APP_TRANSIENT_INTERVAL_US,
+                PRE, POST);
+
+        while (atomic_get(&armed)) {
+            ring_pos = 0;
+            ring_filled = 0;
+            post_left = -1;
+            prev = INT16_MAX;
+
+            int err = adc_read(spec->dev, &seq);
+
+            if (err) {
+                LOG_ERR("capture read failed (%d)", err);
+                atomic_clear(&armed);
+                break;
+            }
+            if (post_left == 0) {
+                queue_capture(spec);
+            }
+        }
+
+        adc_sampling_resume();
+        LOG_INF("capture disarmed");
+    }
+}
+
+K_THREAD_DEFINE(transient_tid, CONFIG_APP_TRANSIENT_STACK_SIZE, transient_thread, NULL, NULL, NULL,
+                CONFIG_APP_TRANSIENT_THREAD_PRIO, 0, 0);
+
+void transient_arm(bool arm)
+{
+    if (arm == (bool)atomic_get(&armed)) {
+        return;
+    }
+    atomic_set(&armed, arm);
+    if (arm) {
+        k_sem_give(&arm_sem);
+    }
+}
+
+bool transient_is_armed(void)
+{
+    return atomic_get(&armed);
+}
+
+uint32_t transient_dropped(void)
+{
+    return atomic_get(&dropped);
+}
+
+/* Download: one capture at a time, in CHUNK-sized notifications, resumable after backpressure */
+static struct transient_capture dl_cap;
+static uint16_t dl_id;
+static uint16_t dl_off;
+static bool dl_active;
+
+static void download_work_handler(struct k_work *work)
+{
+    uint8_t pkt[4 + CHUNK];
+
+    for (;;) {
+        if (!dl_active) {
+            if (k_msgq_get(&capture_q, &dl_cap, K_NO_WAIT)) {
+                return;
+            }
+            dl_active = true;
+            dl_off = 0;
+            dl_id++;
+        }
+
+        while (dl_off < sizeof(dl_cap)) {
+            uint16_t len = MIN(CHUNK, sizeof(dl_cap) - dl_off);
+
+            sys_put_le16(dl_id, &pkt[0]);
+            sys_put_le16(dl_off, &pkt[2]);
+            memcpy(&pkt[4], (const uint8_t *)&dl_cap + dl_off, len);
+
+            int err = notify_transient_chunk(pkt, 4 + len);
+
+            if (err == -ENOTCONN) {
+                /* Nobody subscribed; resume when a client subscribes */
+                return;
+            }
+            if (err) {
+                /* Out of TX buffers; try again shortly */
+                k_work_schedule(k_work_delayable_from_work(work), K_MSEC(20));
+                return;
+            }
+            dl_off += len;
+        }
+        dl_active = false;
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(download_work, download_work_handler);
+
+void transient_download_kick(void)
+{
+    k_work_reschedule(&download_work, K_NO_WAIT);
+}
@@ -3,7 +3,13 @@
 #if IS_ENABLED(CONFIG_WATCHDOG)
 #include <zephyr/drivers/watchdog.h>
 #endif
+#include <string.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/logging/log.h>
+#include "boot_prof.h"
+#include "timer_svc.h"
+#include "watchdog.h"
 LOG_MODULE_REGISTER(APP_WDT, CONFIG_APP_LOG_LEVEL);
 
 #if IS_ENABLED(CONFIG_APP_WDT_ENABLE) && IS_ENABLED(CONFIG_WATCHDOG)
@@ -26,19 +32,156 @@ static const struct device *const wdt_dev = NULL;
 #endif
 
 static int wdt_channel_id = -1;
-static struct k_work_delayable wdt_feed_work;
 
-static void wdt_feed_handler(struct k_work *work)
+struct wdt_chan {
+    const char *name;
+    uint32_t deadline_ms;
+    uint32_t last_ms;
+    bool enabled;
+};
+
+static struct wdt_chan chans[CONFIG_APP_WDT_MAX_CHANNELS];
+static int chan_count;
+static struct k_spinlock chan_lock;
+
+/* Written when a stall is detected; survives the watchdog reset that follows */
+#define STALL_MAGIC 0x57445453 /* "WDTS" */
+static struct {
+    uint32_t magic;
+    struct wdt_stall stall;
+    uint32_t crc;
+} stall_rec __noinit;
+
+static struct wdt_stall last_stall;
+static bool have_last_stall;
+static int workq_chan = -1;
+
+int wdt_chan_register(const char *name, uint32_t deadline_ms)
+{
+    int id = -ENOMEM;
+    k_spinlock_key_t key = k_spin_lock(&chan_lock);
+
+    if (chan_count < ARRAY_SIZE(chans)) {
+        id = chan_count++;
+        chans[id] = (struct wdt_chan){
+            .name = name,
+            .deadline_ms = deadline_ms,
+            .last_ms = k_uptime_get_32(),
+            .enabled = true,
+        };
+    }
+    k_spin_unlock(&chan_lock, key);
+
+    if (id < 0) {
+        LOG_ERR("no free watchdog channel for %s", name);
+    }
+    return id;
+}
+
+void wdt_chan_checkin(int id)
 {
-    if (wdt_channel_id >= 0 && wdt_dev) {
-        (void)wdt_feed(wdt_dev, wdt_channel_id);
+    if (id < 0 || id >= chan_count) {
+        return;
     }
-    /* Feed roughly every half-timeout for margin */
-    k_work_reschedule(&wdt_feed_work, K_MSEC(CONFIG_APP_WDT_TIMEOUT_MS / 2));
+    chans[id].last_ms = k_uptime_get_32();
 }
 
+void wdt_chan_set_deadline(int id, uint32_t deadline_ms)
+{
+    if (id < 0 || id >= chan_count) {
+        return;
+    }
+    chans[id].deadline_ms = deadline_ms;
+}
+
+void wdt_chan_enable(int id, bool enable)
+{
+    if (id < 0 || id >= chan_count) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&chan_lock);
+
+    /* Restart the deadline so the time spent disabled does not count */
+    chans[id].last_ms = k_uptime_get_32();
+    chans[id].enabled = enable;
+    k_spin_unlock(&chan_lock, key);
+}
+
+bool wdt_last_stall(struct wdt_stall *stall)
+{
+    if (have_last_stall) {
+        *stall = last_stall;
+    }
+    return have_last_stall;
+}
+
+static void record_stall(const struct wdt_chan *c, uint32_t now)
+{
+    stall_rec.magic = STALL_MAGIC;
+    strncpy(stall_rec.stall.name, c->name, sizeof(stall_rec.stall.name) - 1);
+    stall_rec.stall.name[sizeof(stall_rec.stall.name) - 1] = '\0';
+    stall_rec.stall.last_run_ms = c->last_ms;
+    stall_rec.stall.deadline_ms = c->deadline_ms;
+    stall_rec.stall.detected_ms = now;
+    stall_rec.crc = crc32_ieee((const uint8_t *)&stall_rec.stall, sizeof(stall_rec.stall));
+}
+
+/* Pick up (and consume) a stall recorded before the last reset */
+static void load_stall(void)
+{
+    if (stall_rec.magic == STALL_MAGIC &&
+        stall_rec.crc == crc32_ieee((const uint8_t *)&stall_rec.stall, sizeof(stall_rec.stall))) {
+        last_stall = stall_rec.stall;
+        have_last_stall = true;
+        LOG_WRN("previous reset: channel %s stalled (last ran at %u ms, deadline %u ms, detected at %u ms)",
+                last_stall.name, last_stall.last_run_ms, last_stall.deadline_ms,
+                last_stall.detected_ms);
+    }
+    stall_rec.magic = 0;
+}
+
+/*
+ * Runs from a kernel timer rather than the system workqueue, so a blocked
+ * workqueue is still detected and attributed to its channel.
+ */
+static void wdt_check_handler(struct k_timer *timer)
+{
+    uint32_t now = k_uptime_get_32();
+    const struct wdt_chan *stalled = NULL;
+    k_spinlock_key_t key = k_spin_lock(&chan_lock);
+
+    for (int i = 0; i < chan_count; i++) {
+        if (chans[i].enabled && now - chans[i].last_ms > chans[i].deadline_ms) {
+            stalled = &chans[i];
+            record_stall(stalled, now);
+            break;
+        }
+    }
+    k_spin_unlock(&chan_lock, key);
+
+    if (stalled) {
+        /* Stop feeding for good; the hardware watchdog resets the SoC */
+        k_timer_stop(timer);
+        LOG_ERR("watchdog channel %s stalled, last ran at %u ms", stalled->name, stalled->last_ms);
+        return;
+    }
+    (void)wdt_feed(wdt_dev, wdt_channel_id);
+}
+
+static K_TIMER_DEFINE(wdt_check_timer, wdt_check_handler, NULL);
+
+/* Proves that the system workqueue (and the timer service on it) still runs */
+static void wdt_workq_handler(struct timer_svc_task *task)
+{
+    wdt_chan_checkin(workq_chan);
+}
+
+static TIMER_SVC_TASK_DEFINE(wdt_workq_task, wdt_workq_handler);
+
 int watchdog_init(void)
 {
+    load_stall();
+
     if (!wdt_dev) {
         LOG_WRN("No watchdog device node found");
         return -ENODEV;
@@ -69,10 +212,17 @@ int watchdog_init(void)
         return err;
     }
 
-    k_work_init_delayable(&wdt_feed_work, wdt_feed_handler);
-    /* Start feeding right away */
-    k_work_reschedule(&wdt_feed_work, K_NO_WAIT);
-    LOG_INF("Watchdog started: %d ms", CONFIG_APP_WDT_TIMEOUT_MS);
+    /* The workqueue checks in at least every quarter-timeout (slack only brings
+     * a check-in forward) and must do so within half the timeout.
+     */
+    workq_chan = wdt_chan_register("sysworkq", CONFIG_APP_WDT_TIMEOUT_MS / 2);
+    timer_svc_start(&wdt_workq_task, CONFIG_APP_WDT_TIMEOUT_MS / 4,
+                    (CONFIG_APP_WDT_TIMEOUT_MS / 4) * MIN(CONFIG_APP_TIMER_SVC_SLACK_PCT, 50) / 100, 0);
+
+    /* Check and feed right away, then every half-timeout */
+    k_timer_start(&wdt_check_timer, K_NO_WAIT, K_MSEC(CONFIG_APP_WDT_TIMEOUT_MS / 2));
+    boot_prof_mark(BOOT_STAGE_WDT_READY);
+    LOG_INF("Watchdog started: %d ms, %d channels", CONFIG_APP_WDT_TIMEOUT_MS, chan_count);
     return 0;
 }
 
@@ -0,0 +1,168 @@
+/*
+ * adc_pm: gets, resumes and suspends across back-to-back and spaced scans
+ *
+ * Runs on the application's native_sim devicetree: the battery channel
+ * (vbatt) sits on the emulated ADC behind its runtime-PM front
+ * (mycompany,adc-pm-emul). Every scan is a real conversion, which the front
+ * refuses while suspended, and the PM actions it received are the ground
+ * truth for the module's counters.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/pm/device_runtime.h>
+#include "adc_pm.h"
+#include "adc_pm_emul.h"
+
+/* Long enough for the deferred release to have run */
+#define SETTLE_MS (CONFIG_APP_ADC_AUTOSUSPEND_MS + 50)
+
+#define VBATT DT_NODELABEL(vbatt)
+#define INPUT_MV 3700
+
+static const struct adc_dt_spec batt = ADC_DT_SPEC_GET(VBATT);
+static const struct device *const dev = DEVICE_DT_GET(DT_IO_CHANNELS_CTLR(VBATT));
+static const struct device *const emul = DEVICE_DT_GET(DT_NODELABEL(adc_emul));
+
+/* Counter deltas over one test */
+static struct adc_pm_stats base;
+static struct adc_pm_emul_counts base_hw;
+
+static int read_mv(int32_t *mv)
+{
+    int16_t raw;
+    struct adc_sequence seq = {
+        .buffer = &raw,
+        .buffer_size = sizeof(raw),
+    };
+    int err;
+
+    (void)adc_sequence_init_dt(&batt, &seq);
+    err = adc_read_dt(&batt, &seq);
+    if (err) {
+        return err;
+    }
+    *mv = raw;
+    return adc_raw_to_millivolts_dt(&batt, mv);
+}
+
+static void scan(void)
+{
+    int32_t mv;
+
+    adc_pm_get();
+    zassert_ok(read_mv(&mv), "conversion on a resumed ADC");
+    zassert_within(mv, INPUT_MV, 2, "%d mV", mv);
+    adc_pm_put();
+}
+
+static void assert_counts(uint32_t gets, uint32_t resumes, uint32_t suspends)
+{
+    struct adc_pm_stats st;
+
+    adc_pm_stats_get(&st);
+    zassert_equal(st.gets - base.gets, gets, "gets");
+    zassert_equal(st.resumes - base.resumes, resumes, "resumes");
+    zassert_equal(st.suspends - base.suspends, suspends, "suspends");
+    /* The counters must match what the device actually went through */
+    struct adc_pm_emul_counts hw;
+
+    adc_pm_emul_counts_get(dev, &hw);
+    zassert_equal(hw.resumes - base_hw.resumes, resumes, "device resumes");
+    zassert_equal(hw.suspends - base_hw.suspends, suspends, "device suspends");
+    zassert_equal(hw.rejected - base_hw.rejected, 0, "reads while suspended");
+}
+
+static void assert_state(enum pm_device_state expected)
+{
+    enum pm_device_state state;
+
+    zassert_ok(pm_device_state_get(dev, &state));
+    zassert_equal(state, expected, "state %d", state);
+}
+
+static void *suite_setup(void)
+{
+    zassert_true(device_is_ready(dev));
+    /* zephyr,pm-device-runtime-auto in the overlay */
+    zassert_true(pm_device_runtime_is_enabled(dev), "runtime PM not enabled at boot");
+    zassert_ok(adc_emul_const_value_set(emul, batt.channel_id, INPUT_MV));
+    zassert_ok(adc_channel_setup_dt(&batt));
+    adc_pm_init(dev);
+    return NULL;
+}
+
+static void before(void *fixture)
+{
+    /* Every test starts from a suspended device */
+    k_msleep(SETTLE_MS);
+    assert_state(PM_DEVICE_STATE_SUSPENDED);
+    adc_pm_stats_get(&base);
+    adc_pm_emul_counts_get(dev, &base_hw);
+}
+
+ZTEST(adc_pm, test_suspended_adc_refuses_conversions)
+{
+    struct adc_pm_emul_counts hw;
+    int32_t mv;
+
+    zassert_equal(read_mv(&mv), -EIO);
+    adc_pm_emul_counts_get(dev, &hw);
+    zassert_equal(hw.rejected - base_hw.rejected, 1);
+    base_hw.rejected = hw.rejected;
+    assert_counts(0, 0, 0);
+}
+
+ZTEST(adc_pm, test_back_to_back_scans_share_one_resume)
+{
+    for (int i = 0; i < 5; i++) {
+        scan();
+    }
+    assert_counts(5, 1, 0);
+    assert_state(PM_DEVICE_STATE_ACTIVE);
+
+    k_msleep(SETTLE_MS);
+    assert_counts(5, 1, 1);
+    assert_state(PM_DEVICE_STATE_SUSPENDED);
+}
+
+ZTEST(adc_pm, test_spaced_scans_cycle_the_device)
+{
+    for (int i = 0; i < 3; i++) {
+        scan();
+        k_msleep(SETTLE_MS);
+    }
+    assert_counts(3, 3, 3);
+    assert_state(PM_DEVICE_STATE_SUSPENDED);
+}
+
+ZTEST(adc_pm, test_scan_within_delay_keeps_device_resumed)
+{
+    scan();
+    k_msleep(CONFIG_APP_ADC_AUTOSUSPEND_MS / 2);
+    scan();
+    assert_counts(2, 1, 0);
+
+    k_msleep(SETTLE_MS);
+    assert_counts(2, 1, 1);
+}
+
+ZTEST(adc_pm, test_held_reference_blocks_suspend)
+{
+    /* e.g. transient capture holding the ADC while periodic scans are paused */
+    adc_pm_get();
+    scan();
+    k_msleep(SETTLE_MS);
+    assert_counts(2, 1, 0);
+    assert_state(PM_DEVICE_STATE_ACTIVE);
+
+    adc_pm_put();
+    k_msleep(SETTLE_MS);
+    assert_counts(2, 1, 1);
+    assert_state(PM_DEVICE_STATE_SUSPENDED);
+}
+
+ZTEST_SUITE(adc_pm, NULL, suite_setup, before, NULL, NULL);
@@ -0,0 +1,270 @@
+/*
+ * app_config: record selection, migration and the flash layout check
+ *
+ * The module is compiled into the test so that records can be laid out in
+ * flash exactly as an older firmware, an interrupted save or the previous
+ * NVS layout would have left them. Runs on the simulated flash of native_sim
+ * with an app_config_partition added by the board overlay.
+ */
+
+#include "app_config.c"
+
+#include <zephyr/ztest.h>
+
+#define STORAGE_ID FIXED_PARTITION_ID(storage_partition)
+
+static const uint32_t marker = 0x5a5aa5a5;
+
+static void v2_build(struct cfg_rec *rec, uint32_t seq, uint32_t interval_ms)
+{
+    struct app_cfg cfg;
+
+    set_defaults(&cfg);
+    cfg.sample_interval_ms = interval_ms;
+    rec_build(rec, &cfg, seq);
+}
+
+static void v1_build(struct cfg_rec *rec, uint32_t seq)
+{
+    struct app_cfg_v1 v1 = {
+        .sample_interval_ms = 2500,
+        .threshold_mv = 3300,
+        .en_ble = 0,
+    };
+
+    memset(rec, 0xff, sizeof(*rec));
+    rec->hdr.magic = CFG_MAGIC;
+    rec->hdr.version = 1;
+    rec->hdr.len = sizeof(v1);
+    rec->hdr.seq = seq;
+    memcpy(rec->payload, &v1, sizeof(v1));
+    rec->hdr.crc = rec_crc(rec);
+}
+
+static void put(int slot, const struct cfg_rec *rec)
+{
+    zassert_ok(slot_write(slot, rec));
+}
+
+static void put_raw(const struct flash_area *fa, off_t off, uint32_t word)
+{
+    zassert_ok(flash_area_write(fa, off, &word, sizeof(word)));
+}
+
+static uint32_t get_raw(const struct flash_area *fa, off_t off)
+{
+    uint32_t word;
+
+    zassert_ok(flash_area_read(fa, off, &word, sizeof(word)));
+    return word;
+}
+
+static const struct flash_area *storage_open(void)
+{
+    const struct flash_area *fa;
+
+    zassert_ok(flash_area_open(STORAGE_ID, &fa));
+    return fa;
+}
+
+/* Boot again: forget the loaded record and read it back from flash */
+static int reboot_init(void)
+{
+    struct k_work_sync sync;
+
+    (void)k_work_cancel_delayable_sync(&save_work, &sync);
+    active_slot = -1;
+    active_seq = 0;
+    return app_config_init();
+}
+
+static void wait_saved(void)
+{
+    struct k_work_sync sync;
+
+    (void)k_work_flush_delayable(&save_work, &sync);
+}
+
+static void *suite_setup(void)
+{
+    /* Opens the partition and sizes the slots */
+    zassert_ok(backend_init());
+    return NULL;
+}
+
+static void before(void *fixture)
+{
+    const struct flash_area *storage = storage_open();
+
+    zassert_ok(flash_area_erase(cfg_fa, 0, cfg_fa->fa_size));
+    zassert_ok(flash_area_erase(storage, 0, storage->fa_size));
+    flash_area_close(storage);
+}
+
+ZTEST(app_config, test_empty_partition_uses_defaults)
+{
+    struct app_cfg def;
+    struct app_cfg cfg;
+
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, -1);
+    set_defaults(&def);
+    app_config_get(&cfg);
+    zassert_mem_equal(&cfg, &def, sizeof(cfg));
+}
+
+ZTEST(app_config, test_v1_record_is_migrated_and_rewritten)
+{
+    static struct cfg_rec rec;
+    struct app_cfg cfg;
+
+    v1_build(&rec, 7);
+    put(0, &rec);
+
+    zassert_ok(reboot_init());
+    app_config_get(&cfg);
+    zassert_equal(cfg.sample_interval_ms, 2500);
+    zassert_equal(cfg.threshold_mv, 3300);
+    zassert_equal(cfg.en_ble, 0);
+    zassert_equal(cfg.notify_every, 1, "field added in v2 takes its default");
+
+    /* The rewrite goes to the other slot; the v1 record stays until it succeeded */
+    wait_saved();
+    zassert_equal(active_slot, 1);
+    zassert_equal(active_seq, 8);
+    zassert_ok(slot_read(1, &rec));
+    zassert_true(rec_ok(&rec));
+    zassert_equal(rec.hdr.version, APP_CFG_VERSION);
+    zassert_ok(slot_read(0, &rec));
+    zassert_equal(rec.hdr.version, 1);
+
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, 1);
+    app_config_get(&cfg);
+    zassert_equal(cfg.sample_interval_ms, 2500);
+}
+
+ZTEST(app_config, test_bad_crc_falls_back_to_older_record)
+{
+    static struct cfg_rec rec;
+    struct app_cfg cfg;
+
+    v2_build(&rec, 5, 1111);
+    put(0, &rec);
+    /* Newer, but torn: the payload changed after the CRC was computed */
+    v2_build(&rec, 6, 2222);
+    rec.payload[0] ^= 0x01;
+    put(1, &rec);
+
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, 0);
+    zassert_equal(active_seq, 5);
+    app_config_get(&cfg);
+    zassert_equal(cfg.sample_interval_ms, 1111);
+}
+
+ZTEST(app_config, test_newest_sequence_wins_across_wrap)
+{
+    static struct cfg_rec rec;
+    struct app_cfg cfg;
+
+    v2_build(&rec, UINT32_MAX, 1111);
+    put(0, &rec);
+    v2_build(&rec, 0, 2222);
+    put(1, &rec);
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, 1);
+    app_config_get(&cfg);
+    zassert_equal(cfg.sample_interval_ms, 2222);
+
+    /* Same records, other slots: the order in flash must not matter */
+    v2_build(&rec, 0, 2222);
+    put(0, &rec);
+    v2_build(&rec, UINT32_MAX, 1111);
+    put(1, &rec);
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, 0);
+    app_config_get(&cfg);
+    zassert_equal(cfg.sample_interval_ms, 2222);
+}
+
+ZTEST(app_config, test_saves_alternate_and_toggle_is_persisted)
+{
+    static struct cfg_rec rec;
+    struct app_cfg cfg;
+
+    v2_build(&rec, 3, 1000);
+    put(0, &rec);
+    zassert_ok(reboot_init());
+
+    app_config_get(&cfg);
+    cfg.sample_interval_ms = 4000;
+    zassert_ok(app_config_set(&cfg));
+    wait_saved();
+    zassert_equal(active_slot, 1);
+
+    bool en = app_config_toggle_en_ble();
+
+    wait_saved();
+    zassert_equal(active_slot, 0, "never overwrites the slot holding the active record");
+    zassert_equal(active_seq, 5);
+
+    zassert_ok(reboot_init());
+    app_config_get(&cfg);
+    zassert_equal(cfg.sample_interval_ms, 4000);
+    zassert_equal(cfg.en_ble, en);
+
+    cfg.threshold_mv = 0;
+    zassert_equal(app_config_set(&cfg), -EINVAL);
+}
+
+ZTEST(app_config, test_old_nvs_layout_is_erased_once)
+{
+    const struct flash_area *storage = storage_open();
+
+    /* An NVS sector from the old layout: data at the start, ATEs at the end */
+    put_raw(cfg_fa, 0, 0x00010203);
+    put_raw(cfg_fa, slot_size - 8, 0xdeadbeef);
+    put_raw(storage, 0, marker);
+
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, -1);
+    zassert_equal(get_raw(cfg_fa, 0), UINT32_MAX);
+    zassert_equal(get_raw(cfg_fa, slot_size - 8), UINT32_MAX);
+    zassert_equal(get_raw(storage, 0), UINT32_MAX, "settings storage erased with it");
+    flash_area_close(storage);
+}
+
+ZTEST(app_config, test_ate_only_tail_is_foreign)
+{
+    static struct cfg_rec rec;
+    const struct flash_area *storage = storage_open();
+
+    /* A valid-looking start is not enough: saves never write the end of a slot */
+    v2_build(&rec, 1, 1111);
+    put(1, &rec);
+    put_raw(cfg_fa, 2 * slot_size - 8, 0xdeadbeef);
+    put_raw(storage, 0, marker);
+
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, -1);
+    zassert_equal(get_raw(storage, 0), UINT32_MAX);
+    flash_area_close(storage);
+}
+
+ZTEST(app_config, test_own_records_leave_storage_alone)
+{
+    static struct cfg_rec rec;
+    const struct flash_area *storage = storage_open();
+
+    v2_build(&rec, 1, 1111);
+    put(0, &rec);
+    put_raw(storage, 0, marker);
+
+    zassert_ok(reboot_init());
+    zassert_equal(active_slot, 0);
+    zassert_equal(get_raw(storage, 0), marker, "settings must survive a normal boot");
+    flash_area_close(storage);
+}
+
+ZTEST_SUITE(app_config, NULL, suite_setup, before, NULL, NULL);